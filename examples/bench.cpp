@@ -0,0 +1,119 @@
+// On-target benchmark: packer throughput, transfer/latch timing and fps.
+// Output goes to stdio (USB or UART); nothing needs to be connected to the pin.
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "ws2812.hpp"
+
+static constexpr uint BENCH_PIN = 16;
+static constexpr uint SIZES[] = {30, 300, 1000, 3000};
+static constexpr int  REPS = 16;
+
+// SysTick as a 24-bit down-counting cycle counter at clk_sys.
+static void cycles_init() {
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // enable, processor clock, no IRQ
+}
+static inline uint32_t cycles_now() { return systick_hw->cvr; }
+static inline uint32_t cycles_since(uint32_t start) { return (start - systick_hw->cvr) & 0x00FFFFFF; }
+
+// Packer only: Strip::pack() into caller memory, no hardware involved.
+static void bench_pack() {
+    printf("\n-- pack (cycles/LED, best of %d) --\n", REPS);
+    printf("%6s %5s %5s %4s %8s %8s\n", "LEDs", "fmt", "gamma", "bri", "RGB src", "RGBW src");
+    for (uint n : SIZES) {
+        std::vector<ws::RGB>  rgb(n, ws::RGB{200, 100, 50});
+        std::vector<ws::RGBW> rgbw(n, ws::RGBW{200, 100, 50, 25});
+        std::vector<uint32_t> out(n);
+        for (bool w : {false, true}) {
+            ws::Strip strip(BENCH_PIN, n, w);
+            for (bool gamma : {false, true}) {
+                strip.enableGamma(gamma);
+                for (uint8_t bri : {255, 128, 16}) {
+                    strip.setBrightness(bri);
+                    uint32_t best3 = UINT32_MAX, best4 = UINT32_MAX;
+                    for (int r = 0; r < REPS; ++r) {
+                        uint32_t t = cycles_now();
+                        strip.pack(rgb.data(), n, out.data());
+                        best3 = std::min(best3, cycles_since(t));
+                        t = cycles_now();
+                        strip.pack(rgbw.data(), n, out.data());
+                        best4 = std::min(best4, cycles_since(t));
+                    }
+                    printf("%6u %5s %5s %4u %8.1f %8.1f\n", n, w ? "RGBW" : "RGB",
+                           gamma ? "on" : "off", bri, (float)best3 / n, (float)best4 / n);
+                }
+            }
+        }
+    }
+}
+
+// Real transfers: arm cost, time until busy() falls, end-to-end show() rate.
+// busy() falls at the driver's own deadline (wire time + drain + reset
+// latch, computed at the start), so "busy" and "busy-wire" show that
+// deadline's margin, not a measured latch.
+static void bench_transfer(bool rgbw, const ws::Strip::Options& opt, const char* label) {
+    printf("\n-- transfer: %s %s (µs, mean of %d) --\n", rgbw ? "RGBW" : "RGB", label, REPS);
+    printf("%6s %8s %8s %8s %8s %8s %8s %7s\n",
+           "LEDs", "pack", "arm", "wire", "busy", "busy-wire", "show()", "fps");
+    for (uint n : SIZES) {
+        ws::Strip strip(BENCH_PIN, n, rgbw);
+        if (!strip.begin(opt)) { printf("%6u begin() failed\n", n); continue; }
+        strip.setAll(ws::RGBW{10, 20, 30, 40});
+        strip.show();
+
+        // showAsync() with a full repack (brightness change) vs showRaw() (no pack)
+        uint64_t t_async = 0, t_raw = 0, t_frame = 0, t_show = 0;
+        for (int r = 0; r < REPS; ++r) {
+            strip.setBrightness((r & 1) ? 200 : 201);
+            uint64_t t = time_us_64();
+            strip.showAsync();
+            t_async += time_us_64() - t;
+            strip.wait();
+
+            t = time_us_64();
+            strip.showRaw();
+            uint64_t armed = time_us_64();
+            t_raw += armed - t;
+            while (strip.busy()) tight_loop_contents();
+            t_frame += time_us_64() - armed;
+        }
+        for (int r = 0; r < REPS; ++r) {
+            strip.setBrightness((r & 1) ? 200 : 201);
+            uint64_t t = time_us_64();
+            strip.show();
+            t_show += time_us_64() - t;
+        }
+        const float wire = n * (rgbw ? 32.0f : 24.0f) / 0.8f; // µs at 800 kHz (1.25 µs per bit)
+        const float async = (float)t_async / REPS, raw = (float)t_raw / REPS;
+        const float frame = (float)t_frame / REPS, show = (float)t_show / REPS;
+        printf("%6u %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %7.1f%s\n", n, async - raw, raw,
+               wire, frame, frame - wire, show, 1e6f / show, strip.hasDma() ? "" : " (no DMA)");
+        strip.end();
+    }
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000); // time to attach a terminal
+    cycles_init();
+
+    printf("ws2812 bench, clk_sys %lu MHz\n", (unsigned long)(clock_get_hz(clk_sys) / 1000000));
+    bench_pack();
+
+    ws::Strip::Options single, dbl, bytes;
+    dbl.double_buffer = true;
+    bytes.byte_wire = true;
+    for (bool rgbw : {false, true}) {
+        bench_transfer(rgbw, single, "single");
+        bench_transfer(rgbw, dbl, "double_buffer");
+        bench_transfer(rgbw, bytes, "byte_wire");
+    }
+
+    printf("\ndone\n");
+    while (true) tight_loop_contents();
+}
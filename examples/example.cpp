@@ -13,15 +13,15 @@ int main() {
     strip.enableGamma(true);   // nicer perception
     strip.setBrightness(128);  // ~50%
 
-    // Rainbow sweep
-    float h = 0.f;
+    // Frames start on the hardware timer every 1/60 s, whatever packing takes
+    strip.setFrameRate(60.0f);
+
+    // Rainbow sweep (hue 0..65535 = 0..360°: 8° per LED, 2.5° per frame, V=40%)
+    uint16_t h = 0;
     while (true) {
-        for (uint i = 0; i < strip.size(); ++i) {
-            strip.setPixel(i, ws::Strip::hsv(h + i*8.f, 1.f, 0.4f));
-        }
-        strip.show();
-        h += 2.5f;
-        sleep_ms(15);
+        strip.fillRainbow(0, strip.size(), h, 1456, 255, 102);
+        strip.showNextFrame(); // packs now, sent at the next tick
+        h += 455;
     }
 
     return 0;
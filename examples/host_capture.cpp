@@ -0,0 +1,22 @@
+// Host build (WS2812_HOST=ON): render a few frames through the real packer
+// and print the captured wire words, one frame per line, for golden-frame diffs.
+#include <cstdio>
+#include "ws2812_capture.hpp"
+
+int main() {
+    ws::CaptureStrip strip(/*count=*/8, /*rgbw=*/false);
+    strip.enableGamma(true);
+    strip.setBrightness(128);
+
+    uint16_t h = 0;
+    for (int f = 0; f < 4; ++f, h += 4096) {
+        strip.fillRainbow(0, strip.size(), h, 8192);
+        strip.show();
+    }
+
+    for (const auto& frame : strip.frames()) {
+        for (uint32_t w : frame) std::printf("%08x ", (unsigned)w);
+        std::printf("\n");
+    }
+    return 0;
+}
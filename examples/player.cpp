@@ -0,0 +1,47 @@
+// Play a pre-packed clip from flash: DMA reads every frame in place.
+// Real clips are baked offline (e.g. with PixelBuffer::pack() in the host
+// build) and linked in as a const array; this one is generated at compile time.
+#include <array>
+#include "pico/stdlib.h"
+#include "ws2812.hpp"
+#include "ws2812_player.hpp"
+
+static constexpr uint32_t PIXELS = 60;
+static constexpr uint32_t FRAMES = 120;
+
+// Header, per-frame brightness (a fade in and out), then GRB wire words for a
+// dot running along the strip. Ends up in flash because it is const.
+struct Clip {
+    ws::ClipHeader hdr;
+    uint8_t        level[FRAMES];
+    uint32_t       words[FRAMES][PIXELS];
+};
+
+static constexpr Clip make_clip() {
+    Clip c{};
+    c.hdr = {ws::CLIP_MAGIC, ws::CLIP_VERSION, (uint8_t)ws::ClipFormat::Wire24,
+             ws::CLIP_BRIGHTNESS, 0, /*fps=*/60, 0, PIXELS, FRAMES};
+    for (uint32_t f = 0; f < FRAMES; ++f) {
+        c.level[f] = (uint8_t)(f < FRAMES / 2 ? f * 255 / (FRAMES / 2) : (FRAMES - f) * 255 / (FRAMES / 2));
+        c.words[f][f % PIXELS] = 0x40FF0000u; // G=0x40 R=0xFF B=0, in bits 31..8
+    }
+    return c;
+}
+
+alignas(4) static constexpr Clip clip = make_clip();
+
+int main() {
+    ws::Strip strip(/*pin=*/16, PIXELS);
+    if (!strip.begin()) {
+        while (true) {}
+    }
+
+    ws::Player player(strip);
+    if (!player.load(&clip) || !player.play()) {
+        while (true) {}
+    }
+
+    while (true) {
+        sleep_ms(1000); // the timer IRQ and DMA do the work
+    }
+}
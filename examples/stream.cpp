@@ -0,0 +1,26 @@
+// Live Adalight stream over UART (e.g. from a USB-serial bridge) into a strip.
+// Host side: any Adalight sender (Hyperion, Prismatik, an Art-Net bridge) at 1 Mbaud.
+#include "pico/stdlib.h"
+#include "ws2812.hpp"
+#include "ws2812_stream.hpp"
+
+int main() {
+    ws::Strip strip(/*pin=*/16, /*count=*/300);
+    ws::Strip::Options opt;
+    opt.double_buffer = true; // pack frame N+1 while frame N is on the wire
+    if (!strip.begin(opt)) {
+        while (true) {}
+    }
+    strip.enableGamma(true);
+
+    // UART0 RX on GPIO1; DMA fills a 4 KB ring, the CPU only sees whole frames
+    ws::StreamSource stream(strip);
+    if (!stream.beginUart(uart0, /*rx_pin=*/1, 1000000)) {
+        while (true) {}
+    }
+
+    while (true) {
+        stream.poll();
+        sleep_us(500); // anything else the loop has to do
+    }
+}
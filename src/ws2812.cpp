@@ -1,8 +1,11 @@
 #include "ws2812.hpp"
-#include <cmath>
+#include "ws2812_detail.hpp"
+#include "ws2812_resources.hpp"
+#include <cstring>
 #include <algorithm>
 
 #include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "hardware/clocks.h"
 #include "hardware/regs/dreq.h"
 #include "pico/stdlib.h"
@@ -12,210 +15,706 @@
 #define WS2812_USE_DMA 1
 #endif
 
+// Statement(s) compiled only with WS2812_STATS; may declare locals.
+#if WS2812_STATS
+#define WS2812_STAT(...) __VA_ARGS__
+#else
+#define WS2812_STAT(...)
+#endif
+
 namespace ws {
 
-static int s_offset_pio0 = -1;
-static int s_offset_pio1 = -1;
+static constexpr uint32_t RESET_US = 80; // reset latch: line held low after the last bit
 
-Strip::Strip(uint pin, uint count, bool rgbw, float freq, PIO pio, int sm)
-: _pin(pin), _count(count), _rgbw(rgbw), _freq(freq),
-  _pio(pio), _sm(sm), _dma_ch(-1), _pio_offset(0),
-  _buf(count), _brightness(255), _gamma_on(false)
+static Strip* s_active = nullptr; // begun strips, linked through _next_active
+
+#if WS2812_USE_DMA
+// Frame-done IRQ routing: DMA channel -> owning strip, users per DMA_IRQ_n line.
+static Strip* s_irq_strip[NUM_DMA_CHANNELS] = {};
+static uint   s_irq_users[2] = {};
+#endif
+
+Strip::Strip(uint pin, uint count, bool rgbw, float freq, PIO pio, int sm, ColorOrder order)
+: PixelBuffer(count, rgbw, order), _pin(pin), _freq(freq),
+  _pio(pio), _sm(-1), _sm_req(sm), _dma_ch(-1), _pio_offset(0)
 {
-    // default gamma is identity until enabled
-    for (int i=0;i<256;++i) _gam[i] = (uint8_t)i;
 }
 
-bool Strip::begin() {
-    // Add PIO program once per PIO block
-    if (_pio == pio0) {
-        if (s_offset_pio0 < 0) s_offset_pio0 = pio_add_program(_pio, &ws2812_program);
-        _pio_offset = (uint)s_offset_pio0;
-    } else {
-        if (s_offset_pio1 < 0) s_offset_pio1 = pio_add_program(_pio, &ws2812_program);
-        _pio_offset = (uint)s_offset_pio1;
-    }
+Strip::Strip(uint pin, uint count, bool rgbw, float freq, PIO pio, int sm,
+             const detail::PackKernels* kern)
+: PixelBuffer(count, rgbw, kern), _pin(pin), _freq(freq),
+  _pio(pio), _sm(-1), _sm_req(sm), _dma_ch(-1), _pio_offset(0)
+{
+}
 
-    // Claim or use provided SM
-    if (_sm < 0) {
-        _sm = pio_claim_unused_sm(_pio, true);
-        if (_sm < 0) return false;
-    }
+bool Strip::begin() { return begin(Options{}); }
+
+bool Strip::begin(const Options& opt) {
+    end(); // re-begin: drop what the previous begin() claimed
+
+    const Timing& t = opt.timing;
+    if (!t.t1 || !t.t2 || !t.t3 || t.t1 > 16 || t.t2 > 16 || t.t3 > 16) return false;
+    _timing = t;
+    if (clkdiv() < 1.0f) return false;
 
-    ws2812_program_init(_pio, (uint)_sm, _pio_offset, _pin, _freq, _rgbw);
+    // One shared copy of the program per PIO block and timing
+    uint16_t insn[detail::MAX_SHARED_PROGRAM_LEN];
+    static_assert(sizeof(ws2812_program_instructions) <= sizeof(insn), "ws2812 program too long");
+    ws2812_program_patch(insn, t.t1, t.t2, t.t3);
+    pio_program_t prog = ws2812_program;
+    prog.instructions = insn;
+    int offset = detail::program_acquire(_pio, &prog);
+    if (offset < 0) return false;
+    _pio_offset = (uint)offset;
+    _prog_loaded = true;
+
+    // Claim the requested SM or any free one
+    _sm = detail::sm_claim(_pio, _sm_req);
+    if (_sm < 0) { end(); return false; }
+
+    _byte_wire = opt.byte_wire;
+    ws2812_program_init(_pio, (uint)_sm, _pio_offset, _pin, _freq,
+                        _byte_wire ? 8 : (_rgbw ? 32 : 24), t.t1 + t.t2 + t.t3);
+    _word_ns = (uint32_t)((_rgbw ? 32.0f : 24.0f) * 1e9f / _freq + 0.5f);
 
 #if WS2812_USE_DMA
     _dma_ch = dma_claim_unused_channel(false);
     if (_dma_ch >= 0) {
         dma_channel_config c = dma_channel_get_default_config(_dma_ch);
         channel_config_set_dreq(&c, pio_get_dreq(_pio, (uint)_sm, true));
-        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        // 8-bit writes are replicated across the FIFO word; 8-bit autopull
+        // shifts out bits 31..24, i.e. exactly that byte.
+        channel_config_set_transfer_data_size(&c, _byte_wire ? DMA_SIZE_8 : DMA_SIZE_32);
         channel_config_set_read_increment(&c, true);
         channel_config_set_write_increment(&c, false);
         dma_channel_configure(_dma_ch, &c,
                               (volatile void*)&_pio->txf[_sm], // write addr
                               nullptr, 0, false);               // will set src/len on start
     }
+    if (_dma_ch >= 0 && opt.max_segments && !_byte_wire) setup_chain(opt.max_segments);
 #endif
-    clear();
+    if (opt.require_dma && _dma_ch < 0) { end(); return false; }
+    set_depth16(opt.depth16 && opt.pixel_buffer);
+    if (!opt.pixel_buffer) release_pixels();
+
+    // staging buffers live until end()/destruction
+    _tx_units = _byte_wire ? _count * _bpp : _count;
+    size_t words = _byte_wire ? (_tx_units + 3) / 4 : _tx_units;
+    const uint chunk = std::min(opt.chunk_pixels ? opt.chunk_pixels : (opt.stream ? 64u : 0u), _count);
+    _stream = opt.stream && chunk;
+    // The DMA IRQ packs chunks with the LUTs after show calls return.
+    if (chunk) reserve_luts();
+    _double_buf = opt.double_buffer && opt.pixel_buffer && !_stream;
+    for (int k=0;k<2;++k) {
+        if (k == 0 ? opt.pixel_buffer && !_stream : _double_buf) _frame_tx[k].assign(words, 0u);
+        else std::vector<uint32_t>().swap(_frame_tx[k]);
+    }
+    const size_t chunk_words = _byte_wire ? ((size_t)chunk * _bpp + 3) / 4 : chunk;
+    for (auto& c : _chunk_tx) c.assign(chunk_words, 0u);
+    _chunk_px.assign(chunk, RGBW{0, 0, 0, 0});
+    _tx_back = 0;
+    _tx_in_flight = false;
+    clear(); // also marks both staging buffers for a full repack
+    // The chunk ring is refilled from the DMA completion IRQ.
+    if (chunk) attach_irq(0);
+    WS2812_STAT(resetStats());
+    _next_active = s_active;
+    s_active = this;
     return true;
 }
 
+Strip::~Strip() { end(); }
+
 void Strip::end() {
-#if WS2812_USE_DMA
+    for (Strip** p = &s_active; *p; p = &(*p)->_next_active)
+        if (*p == this) { *p = _next_active; _next_active = nullptr; break; }
+    if (_start_pending) {
+        cancel_alarm(_start_alarm);
+        _start_alarm = 0;
+        _start_pending = false;
+    }
+    detach_irq();
     stop_dma();
+    _streaming = false;
+    _st_sum_pending = false;
+    _tx_in_flight = false;
+    _tx_units = 0;
+    _missed = 0;
+    _frame_tick = nil_time;
+#if WS2812_USE_DMA
+    if (_ctrl_ch >= 0) { dma_channel_unclaim(_ctrl_ch); _ctrl_ch = -1; }
+    _cblocks.clear();
+    _chained = false;
     if (_dma_ch >= 0) { dma_channel_unclaim(_dma_ch); _dma_ch = -1; }
 #endif
     if (_sm >= 0) { pio_sm_set_enabled(_pio, (uint)_sm, false); pio_sm_unclaim(_pio, (uint)_sm); _sm = -1; }
+    if (_prog_loaded) { detail::program_release(_pio, _pio_offset); _prog_loaded = false; }
 }
 
-void Strip::clear() { setAll(RGBW{0,0,0,0}); }
+float Strip::clkdiv() const {
+    return ws2812_clkdiv(_freq, (uint)_timing.t1 + _timing.t2 + _timing.t3);
+}
 
-void Strip::setAll(RGB c) { setAll(RGBW{c.r, c.g, c.b, 0}); }
+bool Strip::retime() {
+    if (_sm < 0) return false;
+    float div = clkdiv();
+    if (div < 1.0f) return false;
+    pio_sm_set_clkdiv(_pio, (uint)_sm, div);
+    return true;
+}
 
-void Strip::setAll(RGBW c) {
-    std::fill(_buf.begin(), _buf.end(), c);
+bool Strip::retimeAll() {
+    bool ok = true;
+    for (Strip* s = s_active; s; s = s->_next_active) ok &= s->retime();
+    return ok;
 }
 
-void Strip::setPixel(uint i, RGB c) {
-    if (i >= _count) return;
-    _buf[i] = RGBW{c.r, c.g, c.b, 0};
+void Strip::start_dma(const uint32_t* data, size_t units) {
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0) {
+        if (_chained) set_chained(false);
+        dma_channel_set_read_addr(_dma_ch, data, false);
+        dma_channel_set_trans_count(_dma_ch, (uint)units, true);
+        return;
+    }
+#endif
+    // fallback: blocking if no DMA channel claimed
+    WS2812_STAT(++_stats.blocking_frames);
+    if (_byte_wire) {
+        const uint8_t* b = reinterpret_cast<const uint8_t*>(data);
+        for (size_t i=0;i<units;++i) pio_sm_put_blocking(_pio, (uint)_sm, uint32_t(b[i]) << 24);
+    } else {
+        for (size_t i=0;i<units;++i) pio_sm_put_blocking(_pio, (uint)_sm, data[i]);
+    }
 }
 
-void Strip::setPixel(uint i, uint8_t r, uint8_t g, uint8_t b) {
-    if (i >= _count) return;
-    _buf[i] = RGBW{r,g,b,0};
+void Strip::stop_dma() {
+#if WS2812_USE_DMA
+    if (_dma_ch < 0) return;
+    // RP2040-E13: abort can raise a spurious completion IRQ; mask it meanwhile.
+    if (_dma_irq >= 0) dma_irqn_set_channel_enabled((uint)_dma_irq, (uint)_dma_ch, false);
+    if (_ctrl_ch >= 0) dma_channel_abort(_ctrl_ch); // no more reloads
+    dma_channel_abort(_dma_ch);
+    if (_dma_irq >= 0) {
+        dma_irqn_acknowledge_channel((uint)_dma_irq, (uint)_dma_ch);
+        dma_irqn_set_channel_enabled((uint)_dma_irq, (uint)_dma_ch, true);
+    }
+#endif
 }
 
-void Strip::setPixel(uint i, RGBW c) {
-    if (i >= _count) return;
-    _buf[i] = c;
+#if WS2812_USE_DMA
+void Strip::setup_chain(uint max_segments) {
+    _ctrl_ch = dma_claim_unused_channel(false);
+    if (_ctrl_ch < 0) return;
+    _cblocks.assign((size_t)max_segments + 1, ControlBlock{0, nullptr});
+    // Each trigger copies one {count, read_addr} block into the data channel's
+    // alias-3 registers; writing READ_ADDR_TRIG starts it. The 8-byte write
+    // ring brings the write address back for the next block.
+    dma_channel_config c = dma_channel_get_default_config(_ctrl_ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 3);
+    dma_channel_configure(_ctrl_ch, &c,
+                          &dma_channel_hw_addr(_dma_ch)->al3_transfer_count,
+                          _cblocks.data(), 2, false);
 }
 
-void Strip::setBrightness(uint8_t b) { _brightness = b; }
+void Strip::set_chained(bool on) {
+    // Chained: every finished segment re-triggers the control channel, and the
+    // IRQ (quiet mode) only fires on the terminating null trigger.
+    dma_channel_config c = dma_get_channel_config(_dma_ch);
+    channel_config_set_chain_to(&c, on ? _ctrl_ch : _dma_ch); // self = no chaining
+    channel_config_set_irq_quiet(&c, on);
+    dma_channel_set_config(_dma_ch, &c, false);
+    _chained = on;
+}
+#endif
 
-void Strip::enableGamma(bool on) {
-    _gamma_on = on;
-    if (on) {
-        for (int i=0;i<256;++i) {
-            float x = i/255.0f;
-            // simple sRGB-ish gamma ~2.2
-            uint8_t y = (uint8_t)std::round(std::pow(x, 2.2f) * 255.0f);
-            _gam[i] = y;
-        }
-    } else {
-        for (int i=0;i<256;++i) _gam[i] = (uint8_t)i;
-    }
+bool Strip::showSegments(const WireSegment* segs, size_t n) {
+#if WS2812_USE_DMA
+    if (_ctrl_ch < 0 || n > _cblocks.size() - 1) return false;
+    size_t words = 0;
+    for (size_t i=0;i<n;++i) words += segs[i].count;
+    if (words > _count) return false;
+    wait(); // the previous frame may still be walking _cblocks
+    size_t k = 0;
+    for (size_t i=0;i<n;++i)
+        if (segs[i].count) _cblocks[k++] = ControlBlock{segs[i].count, segs[i].words};
+    _cblocks[k] = ControlBlock{0, nullptr}; // null trigger ends the chain
+    if (!k) return true;
+    if (!_chained) set_chained(true);
+    mark_sent(words);
+    dma_channel_set_read_addr(_ctrl_ch, _cblocks.data(), true);
+    return true;
+#else
+    (void)segs; (void)n;
+    return false;
+#endif
 }
 
-static inline uint8_t scale_u8(uint8_t v, uint8_t b) {
-    // integer scale with rounding: (v*b)/255
-    return (uint8_t)((uint16_t(v) * (uint16_t)b + 127) / 255);
+bool Strip::onFrameDone(FrameDoneFn cb, void* ctx, uint dma_irq) {
+    if (_streaming) wait(); // the IRQ is feeding the chunk ring
+    detach_irq();
+    _done_ctx = ctx;
+    _done_cb = cb;
+    if (!cb && _chunk_px.empty()) return true;
+    if (!attach_irq(dma_irq)) { _done_cb = nullptr; return false; }
+    // Without a DMA channel the latch alarm is armed straight from showAsync().
+    return true;
 }
 
-void Strip::build_frame(std::vector<uint32_t>& out) {
-    out.resize(_count);
-    if (_rgbw) {
-        for (uint i=0;i<_count;++i) {
-            RGBW p = _buf[i];
-            uint8_t r = scale_u8(_gamma_on ? _gam[p.r] : p.r, _brightness);
-            uint8_t g = scale_u8(_gamma_on ? _gam[p.g] : p.g, _brightness);
-            uint8_t b = scale_u8(_gamma_on ? _gam[p.b] : p.b, _brightness);
-            uint8_t w = scale_u8(_gamma_on ? _gam[p.w] : p.w, _brightness);
-            // SK6812 expects GRBW, MSB-first. With left-shift OSR+autopull 32,
-            // we push the 32-bit word directly (no <<8).
-            uint32_t grbw = (uint32_t(g)<<24) | (uint32_t(r)<<16) | (uint32_t(b)<<8) | w;
-            out[i] = grbw;
-        }
-    } else {
-        for (uint i=0;i<_count;++i) {
-            RGBW p = _buf[i];
-            uint8_t r = scale_u8(_gamma_on ? _gam[p.r] : p.r, _brightness);
-            uint8_t g = scale_u8(_gamma_on ? _gam[p.g] : p.g, _brightness);
-            uint8_t b = scale_u8(_gamma_on ? _gam[p.b] : p.b, _brightness);
-            // WS2812(B) expects GRB, 24-bit. With 24-bit autopull + left shift,
-            // align MSB to bit31..8 -> shift <<8 when writing 32-bit into FIFO.
-            uint32_t grb = (uint32_t(g)<<16) | (uint32_t(r)<<8) | b;
-            out[i] = (grb << 8); // align to OSR MSB
+bool Strip::attach_irq(uint dma_irq) {
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0) {
+        if (dma_irq > 1) return false;
+        s_irq_strip[_dma_ch] = this;
+        _dma_irq = (int8_t)dma_irq;
+        if (s_irq_users[dma_irq]++ == 0) {
+            irq_add_shared_handler(DMA_IRQ_0 + dma_irq, dma_irq == 0 ? dma_irq0 : dma_irq1,
+                                   PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_0 + dma_irq, true);
         }
+        dma_irqn_acknowledge_channel(dma_irq, (uint)_dma_ch);
+        dma_irqn_set_channel_enabled(dma_irq, (uint)_dma_ch, true);
     }
+#else
+    (void)dma_irq;
+#endif
+    return true;
 }
 
+void Strip::detach_irq() {
+    if (_done_alarm > 0) { cancel_alarm(_done_alarm); _done_alarm = 0; }
 #if WS2812_USE_DMA
-void Strip::start_dma(const uint32_t* data, size_t words) {
-    if (_dma_ch < 0) {
-        // fallback: blocking if no DMA channel claimed
-        for (size_t i=0;i<words;++i) pio_sm_put_blocking(_pio, (uint)_sm, data[i]);
-        return;
+    if (_dma_irq >= 0) {
+        uint irq = (uint)_dma_irq;
+        dma_irqn_set_channel_enabled(irq, (uint)_dma_ch, false);
+        dma_irqn_acknowledge_channel(irq, (uint)_dma_ch);
+        s_irq_strip[_dma_ch] = nullptr;
+        // Leave the line enabled: other code may share it.
+        if (--s_irq_users[irq] == 0) irq_remove_handler(DMA_IRQ_0 + irq, irq == 0 ? dma_irq0 : dma_irq1);
+        _dma_irq = -1;
     }
-    dma_channel_set_read_addr(_dma_ch, data, false);
-    dma_channel_set_trans_count(_dma_ch, (uint)words, true);
+#endif
+    _done_cb = nullptr;
 }
 
-void Strip::stop_dma() {
-    if (_dma_ch >= 0) dma_channel_abort(_dma_ch);
+#if WS2812_USE_DMA
+void Strip::irq_service(uint irq) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        Strip* s = s_irq_strip[ch];
+        if (!s || s->_dma_irq != (int8_t)irq || !dma_irqn_get_channel_status(irq, ch)) continue;
+        dma_irqn_acknowledge_channel(irq, ch);
+        if (s->_streaming) s->stream_irq();
+        else if (s->_done_cb) s->arm_done_alarm();
+    }
 }
+
+void Strip::dma_irq0() { irq_service(0); }
+void Strip::dma_irq1() { irq_service(1); }
 #endif
 
-bool Strip::busy() const {
+void Strip::arm_done_alarm() {
+    // DMA is done but the FIFO is still draining; fire once the latch elapsed.
+    alarm_id_t id = add_alarm_at(_latch_until, latch_alarm, this, true);
+    if (id > 0) _done_alarm = id;
+}
+
+int64_t Strip::latch_alarm(alarm_id_t, void* user) {
+    Strip* s = static_cast<Strip*>(user);
+    s->_done_alarm = 0;
+    if (s->_done_cb) s->_done_cb(*s, s->_done_ctx);
+    return 0; // one-shot
+}
+
+absolute_time_t Strip::set_latch(size_t pixels) {
+    // The SM is idle (previous frame waited for), so the wire frame starts now
+    // and runs at a fixed rate; DMA/FIFO only ever run ahead of it.
+    uint64_t frame_us = ((uint64_t)pixels * _word_ns + 999) / 1000;
+    absolute_time_t now = get_absolute_time();
+    _latch_until = delayed_by_us(now, frame_us + 1 + RESET_US);
+    _tx_in_flight = true;
+    return now;
+}
+
+void Strip::mark_sent(size_t pixels) {
+    absolute_time_t now = set_latch(pixels);
+#if WS2812_STATS
+    uint64_t t = to_us_since_boot(now);
+    if (_stats.frames++) {
+        uint32_t dt = (uint32_t)(t - _last_start_us);
+        _stats.interval_sum_us += dt;
+        if (dt > _stats.max_interval_us) _stats.max_interval_us = dt;
+    }
+    _last_start_us = t;
+#else
+    (void)now;
+#endif
+}
+
+bool Strip::dma_busy() const {
 #if WS2812_USE_DMA
-    if (_dma_ch >= 0) return dma_channel_is_busy(_dma_ch);
+    if (_dma_ch >= 0 && dma_channel_is_busy(_dma_ch)) return true;
+    if (_ctrl_ch >= 0 && dma_channel_is_busy(_ctrl_ch)) return true; // between segments
 #endif
     return false;
 }
 
+bool Strip::busy() const {
+    if (_start_pending || _streaming) return true;
+    if (!_tx_in_flight) return false;
+    if (dma_busy()) return true;
+    return !time_reached(_latch_until); // FIFO draining or latching
+}
+
 void Strip::wait() {
-#if WS2812_USE_DMA
-    if (_dma_ch >= 0) while (dma_channel_is_busy(_dma_ch)) { tight_loop_contents(); }
-#endif
-    sleep_us(80); // reset latch
+    if (_start_pending || _tx_in_flight) {
+        WS2812_STAT(uint64_t t0 = time_us_64());
+        while (_start_pending) { tight_loop_contents(); } // showAt() frame not out yet
+        while (_streaming || dma_busy()) { tight_loop_contents(); } // streaming: chunks left
+        sleep_until(_latch_until); // only the part of drain + latch not yet elapsed
+        _tx_in_flight = false;
+        WS2812_STAT(_stats.wait_us += time_us_64() - t0);
+    }
+    if (_st_sum_pending) {
+        // Not in stream_irq(): the limiter rewrites the LUT the chunks were packed with.
+        _st_sum_pending = false;
+        limit_power(_st_sum);
+    }
+}
+
+bool Strip::pack_frame() {
+    if (!_tx_units || _frame_tx[0].empty()) return false; // begin() not called, or no staging
+    WS2812_STAT(if (busy()) ++_stats.overlapped);
+    const uint k = _tx_back;
+    if (needs_pack(k)) {
+        // Single buffer: it is still being read by the previous transfer.
+        if (!_double_buf) wait();
+        WS2812_STAT(uint64_t t0 = time_us_64());
+        pack_dirty(_frame_tx[k].data(), k);
+        WS2812_STAT(_stats.pack_us += time_us_64() - t0);
+    }
+    wait(); // previous frame (other buffer) must finish before this one starts
+    return true;
+}
+
+bool Strip::pack_frame(const uint8_t* src, uint stride, uint n) {
+    if (!_tx_units || _frame_tx[0].empty()) return false; // begin() not called, or no staging
+    WS2812_STAT(if (busy()) ++_stats.overlapped);
+    if (!_double_buf) wait();
+    WS2812_STAT(uint64_t t0 = time_us_64());
+    pack_from(_frame_tx[_tx_back].data(), _tx_back, src, stride, n);
+    WS2812_STAT(_stats.pack_us += time_us_64() - t0);
+    wait();
+    return true;
+}
+
+void Strip::send(const uint32_t* data, size_t units, size_t pixels) {
+    mark_sent(pixels);
+    start_dma(data, units);
+    if (_done_cb && _dma_ch < 0) arm_done_alarm(); // blocking fallback: no DMA IRQ
+}
+
+void Strip::send_frame(size_t pixels) {
+    send(_frame_tx[_tx_back].data(), _byte_wire ? pixels * _bpp : pixels, pixels);
+    if (_double_buf) _tx_back ^= 1;
+}
+
+bool Strip::tryShowAsync() {
+    if (busy()) return false;
+    _tx_in_flight = false; // latch elapsed: nothing left for wait() to sleep on
+    showAsync();
+    return true;
 }
 
 void Strip::showAsync() {
-    std::vector<uint32_t> frame;
-    build_frame(frame);
+    if (_stream) stream_own();
+    else if (pack_frame()) send_frame(_count);
+}
+
+bool Strip::showAt(absolute_time_t deadline) {
+    if (_stream) {
+        // Nothing to pack ahead: wait for the deadline, then stream.
+        if (!_tx_units || !_npx) return false;
+        wait();
+        const bool late = time_reached(deadline);
+        if (late) ++_missed;
+        else sleep_until(deadline);
+        stream_own();
+        return !late;
+    }
+    if (!pack_frame()) return false;
+    if (time_reached(deadline)) {
+        ++_missed;
+        send_frame(_count);
+        return false;
+    }
+    if (_dma_ch < 0) { // blocking send: not from an IRQ
+        sleep_until(deadline);
+        send_frame(_count);
+        return true;
+    }
+    // Hand the packed buffer to the alarm; the next pack goes to the other one.
+    _sched_data = _frame_tx[_tx_back].data();
+    _sched_units = _byte_wire ? (size_t)_count * _bpp : _count;
+    _sched_pixels = _count;
+    if (_double_buf) _tx_back ^= 1;
+    _start_pending = true;
+    alarm_id_t id = add_alarm_at(deadline, start_alarm, this, true);
+    if (id > 0) _start_alarm = id;
+    else if (id < 0) start_alarm(0, this); // no alarm slot: start now
+    return true;
+}
+
+int64_t Strip::start_alarm(alarm_id_t, void* user) {
+    Strip* s = static_cast<Strip*>(user);
+    s->send(s->_sched_data, s->_sched_units, s->_sched_pixels);
+    s->_start_alarm = 0;
+    s->_start_pending = false;
+    return 0; // one-shot
+}
+
+void Strip::setFrameRate(float hz) {
+    _frame_us = hz > 0.0f ? (uint32_t)(1e6f / hz + 0.5f) : 0;
+    _frame_tick = nil_time; // restart the clock on the next frame
+}
+
+bool Strip::showNextFrame() {
+    if (!_frame_us || is_nil_time(_frame_tick)) {
+        showAsync();
+        _frame_tick = get_absolute_time();
+        return true;
+    }
+    _frame_tick = delayed_by_us(_frame_tick, _frame_us);
+    if (showAt(_frame_tick)) return true;
+    _frame_tick = get_absolute_time(); // re-anchor to the late frame
+    return false;
+}
+
+void Strip::showFrom(const RGB* src, size_t n) {
+    n = std::min(n, (size_t)_count);
+    if (_stream) stream_from(reinterpret_cast<const uint8_t*>(src), 3, n);
+    else if (pack_frame(reinterpret_cast<const uint8_t*>(src), 3, (uint)n)) send_frame(n);
+}
+
+void Strip::showFrom(const RGBW* src, size_t n) {
+    n = std::min(n, (size_t)_count);
+    if (_stream) stream_from(reinterpret_cast<const uint8_t*>(src), 4, n);
+    else if (pack_frame(reinterpret_cast<const uint8_t*>(src), 4, (uint)n)) send_frame(n);
+}
+
+void Strip::showFrom(const uint32_t* words, size_t n) {
+    if (!_tx_units) return; // begin() not called
+    n = std::min(n, (size_t)_count);
+    if (_byte_wire) {
+        // 8-bit DMA can't read the words: unpack them into the staging buffer.
+        if (_frame_tx[0].empty()) return;
+        if (!_double_buf) wait();
+        for (uint i=0;i<n;++i) setPixelRaw(i, words[i]);
+        wait();
+        send_frame(n);
+        return;
+    }
+    wait();
+    send(words, n, n); // zero-copy: DMA reads the caller's buffer
+}
+
+void Strip::send_from_irq(const uint32_t* words, size_t n) {
+    if (!_tx_units) return; // begin() not called
+    n = std::min(n, (size_t)_count);
+    if (_byte_wire) {
+        if (_frame_tx[0].empty()) return;
+        for (uint i=0;i<n;++i) setPixelRaw(i, words[i]); // staging is idle: not busy()
+        send_frame(n);
+        return;
+    }
+    send(words, n, n);
+}
+
+bool Strip::showChunked(PixelSourceFn src, void* ctx) {
+    if (!_tx_units || _chunk_px.empty() || !src) return false;
+    WS2812_STAT(if (busy()) ++_stats.overlapped);
+    wait();
+    _st_fn = src;
+    _st_ctx = ctx;
+    _st_16 = false;
+    stream_start(_count);
+    return true;
+}
+
+void Strip::stream_own() {
+    if (!_tx_units || !_npx) return; // begin() not called, or no pixel buffer
+    WS2812_STAT(if (busy()) ++_stats.overlapped);
+    wait();
+    _st_fn = nullptr;
+    _st_16 = _depth16;
+    _st_src = _buf.data();
+    _st_stride = _bpp;
+    stream_start(_count);
+}
+
+void Strip::stream_from(const uint8_t* src, uint stride, size_t n) {
+    if (!_tx_units || !n) return;
+    WS2812_STAT(if (busy()) ++_stats.overlapped);
+    wait();
+    _st_fn = nullptr;
+    _st_16 = false;
+    _st_src = src;
+    _st_stride = stride;
+    stream_start((uint)n);
+    // Packing reads src: only return once the last chunk is packed.
+    while (_st_next < _st_count) tight_loop_contents();
+}
+
+void Strip::stream_start(uint pixels) {
+    _st_count = pixels;
+    _st_next = 0;
+    _st_sum = 0;
+    _st_cur = 0;
 #if WS2812_USE_DMA
-    start_dma(frame.data(), frame.size());
-#else
-    for (auto w : frame) pio_sm_put_blocking(_pio, (uint)_sm, w);
+    if (_dma_ch >= 0 && _dma_irq >= 0) {
+        const uint irq = (uint)_dma_irq, ch = (uint)_dma_ch;
+        // Masked while the second half is packed; a completion meanwhile
+        // stays latched and is serviced on unmask.
+        dma_irqn_set_channel_enabled(irq, ch, false);
+        dma_irqn_acknowledge_channel(irq, ch);
+        stream_fill(0);
+        _streaming = true;
+        mark_sent(pixels); // the wire runs gap-free from here if chunks keep up
+        stream_send(0);
+        stream_fill(1);
+        dma_irqn_set_channel_enabled(irq, ch, true);
+        return;
+    }
 #endif
-    // NOTE: frame must live until DMA completes. To keep API simple,
-    // we block-copy via DMA immediately in show() and keep async only for advanced users.
-    // If you want truly async, keep a member staging buffer.
+    // No DMA IRQ: pack each chunk here while the other one is on its way out.
+    stream_fill(0);
+    mark_sent(pixels);
+    for (uint k = 0;; k ^= 1) {
+        stream_send(k);
+        stream_fill(k ^ 1);
+        if (!_st_n[k ^ 1]) break;
+        while (dma_busy()) tight_loop_contents();
+    }
+    if (_done_cb) arm_done_alarm();
+    limit_power(_st_sum); // applied from the next frame on, as for show()
+}
+
+void Strip::stream_fill(uint k) {
+    const uint first = _st_next;
+    const uint n = std::min((uint)_chunk_px.size(), _st_count - first);
+    _st_n[k] = n;
+    if (!n) return;
+    uint32_t* out = _chunk_tx[k].data();
+    WS2812_STAT(uint64_t t0 = time_us_64());
+    if (_st_fn) {
+        _st_fn(_st_ctx, first, n, _chunk_px.data());
+        _st_sum += build_frame(out, 0, reinterpret_cast<const uint8_t*>(_chunk_px.data()), 4, n);
+    } else if (_st_16) {
+        _st_sum += build_frame16(out, first, n);
+    } else {
+        _st_sum += build_frame(out, 0, _st_src + (size_t)first * _st_stride, _st_stride, n);
+    }
+    WS2812_STAT(_stats.pack_us += time_us_64() - t0);
+    _st_next = first + n;
+}
+
+void Strip::stream_send(uint k) {
+    start_dma(_chunk_tx[k].data(), _byte_wire ? (size_t)_st_n[k] * _bpp : _st_n[k]);
+}
+
+void Strip::stream_irq() {
+    // DMA IRQ: half `done` has been read out; keep the other one going.
+    const uint done = _st_cur, next = done ^ 1;
+    if (_st_n[next]) {
+        stream_send(next);
+        _st_cur = (uint8_t)next;
+        stream_fill(done);
+        return;
+    }
+    _streaming = false;
+    _st_sum_pending = true; // limit_power() runs in wait(), off the IRQ
+    if (_done_cb) arm_done_alarm();
+}
+
+uint32_t* Strip::wireBuffer() {
+    if (_byte_wire || !_tx_units || _frame_tx[0].empty()) return nullptr;
+    // The caller may write anything: repack fully before the next show().
+    _dirty_lo[_tx_back] = 0; _dirty_hi[_tx_back] = _count;
+    return _frame_tx[_tx_back].data();
+}
+
+void Strip::setPixelRaw(uint i, uint32_t word) {
+    std::vector<uint32_t>& tx = _frame_tx[_tx_back];
+    if (i >= _count || !_tx_units || tx.empty()) return;
+    if (_byte_wire) {
+        uint8_t* o = reinterpret_cast<uint8_t*>(tx.data()) + (size_t)i * _bpp;
+        o[0] = (uint8_t)(word >> 24); o[1] = (uint8_t)(word >> 16); o[2] = (uint8_t)(word >> 8);
+        if (_rgbw) o[3] = (uint8_t)word;
+    } else {
+        tx[i] = word;
+    }
+    uint k = _tx_back; // this word no longer mirrors _buf[i]
+    if (i < _dirty_lo[k]) _dirty_lo[k] = i;
+    if (i + 1 > _dirty_hi[k]) _dirty_hi[k] = i + 1;
+}
+
+void Strip::showRaw() {
+    if (!_tx_units || _frame_tx[0].empty()) return; // begin() not called, or no staging
+    wait();
+    send_frame(_count);
 }
 
 void Strip::show() {
-    std::vector<uint32_t> frame;
-    build_frame(frame);
-#if WS2812_USE_DMA
-    start_dma(frame.data(), frame.size());
-    if (_dma_ch >= 0) while (dma_channel_is_busy(_dma_ch)) { tight_loop_contents(); }
-#else
-    for (auto w : frame) pio_sm_put_blocking(_pio, (uint)_sm, w);
-#endif
-    sleep_us(80);
-}
-
-ws::RGB Strip::hsv(float h, float s, float v) {
-    h = fmodf(h, 360.0f); if (h < 0) h += 360.0f;
-    s = std::clamp(s, 0.0f, 1.0f);
-    v = std::clamp(v, 0.0f, 1.0f);
-    float c = v * s;
-    float x = c * (1.0f - fabsf(fmodf(h/60.0f, 2.0f) - 1.0f));
-    float m = v - c;
-    float r=0,g=0,b=0;
-    int seg = (int)(h/60.0f);
-    switch(seg) {
-        case 0: r=c; g=x; b=0; break;
-        case 1: r=x; g=c; b=0; break;
-        case 2: r=0; g=c; b=x; break;
-        case 3: r=0; g=x; b=c; break;
-        case 4: r=x; g=0; b=c; break;
-        default:r=c; g=0; b=x; break;
-    }
-    return RGB{ (uint8_t)std::round((r+m)*255.0f),
-                (uint8_t)std::round((g+m)*255.0f),
-                (uint8_t)std::round((b+m)*255.0f) };
+    showAsync();
+    wait();
+}
+
+bool StripGroup::add(Strip& s) {
+    if (_n >= MAX_STRIPS) return false;
+    // pack_frame() needs the staging buffer; stream/pixel-less strips would never be sent.
+    if (!s._tx_units || s._frame_tx[0].empty()) return false;
+    for (uint i=0;i<_n;++i) if (_strips[i] == &s) return false;
+    _strips[_n++] = &s;
+    return true;
+}
+
+void StripGroup::showAsync() {
+    // Pack everything first so the starts below are back-to-back.
+    bool ready[MAX_STRIPS];
+    for (uint i=0;i<_n;++i) ready[i] = _strips[i]->pack_frame();
+
+    uint32_t sm_mask[NUM_PIOS] = {};
+    for (uint i=0;i<_n;++i) {
+        Strip& s = *_strips[i];
+        if (ready[i] && s._dma_ch >= 0) sm_mask[pio_get_index(s._pio)] |= 1u << s._sm;
+    }
+
+    // Stop the SMs, let DMA prefill their FIFOs, then release them together.
+    for (uint p=0;p<NUM_PIOS;++p) if (sm_mask[p]) pio_set_sm_mask_enabled(pio_get_instance(p), sm_mask[p], false);
+    for (uint i=0;i<_n;++i) if (ready[i] && _strips[i]->_dma_ch >= 0) _strips[i]->send_frame(_strips[i]->_count);
+    for (uint p=0;p<NUM_PIOS;++p) if (sm_mask[p]) pio_enable_sm_mask_in_sync(pio_get_instance(p), sm_mask[p]);
+    // The wire frames started just now, not when DMA was armed (stats were
+    // already counted by send_frame()).
+    for (uint i=0;i<_n;++i) if (ready[i] && _strips[i]->_dma_ch >= 0) _strips[i]->set_latch(_strips[i]->_count);
+
+    // Members without a DMA channel can only be fed one after another.
+    for (uint i=0;i<_n;++i) if (ready[i] && _strips[i]->_dma_ch < 0) _strips[i]->send_frame(_strips[i]->_count);
+}
+
+void StripGroup::show() {
+    showAsync();
+    wait();
+}
+
+bool StripGroup::busy() const {
+    for (uint i=0;i<_n;++i) if (_strips[i]->busy()) return true;
+    return false;
+}
+
+void StripGroup::wait() {
+    for (uint i=0;i<_n;++i) _strips[i]->wait();
 }
 
 } // namespace ws
@@ -2,18 +2,21 @@
 #include <cstdint>
 #include <vector>
 #include "hardware/pio.h"
+#include "pico/time.h"
+#include "ws2812_pixels.hpp"
 
-namespace ws {
+// Per-strip counters (Strip::stats()). Off by default; changes the class
+// layout, so define it for the library and everything including this header.
+#ifndef WS2812_STATS
+#define WS2812_STATS 0
+#endif
 
-/**
- * @brief 8-bit RGB color (0..255 per channel).
- */
-struct RGB { uint8_t r, g, b; };
+namespace ws {
 
 /**
- * @brief 8-bit RGBW color (0..255 per channel). W is ignored on plain WS2812.
+ * @brief A run of pre-packed wire words (see Strip::wireBuffer()) for Strip::showSegments().
  */
-struct RGBW { uint8_t r, g, b, w; };
+struct WireSegment { const uint32_t* words; uint32_t count; };
 
 /**
  * @brief RP2040 WS2812/WS2812B (RGB) and SK6812 (RGBW) driver using Pico SDK + PIO.
@@ -21,27 +24,98 @@ struct RGBW { uint8_t r, g, b, w; };
  * Key points:
  * - Uses one PIO state machine; 800 kHz default (configurable).
  * - Optional DMA (on by default). Falls back to blocking if no channel is free.
- * - Internal logic stores RGBW; W is dropped for RGB strips.
+ * - Pixels are stored natively: 3 bytes (RGB) or 4 bytes (RGBW) per LED.
  * - Global brightness (0..255) and optional ~2.2 gamma correction.
+ * - Any colour order (ColorOrder) picked at construction; BasicStrip fixes
+ *   order and format at compile time instead.
+ * - Pixel setters, brightness/gamma, power limiting and colour helpers come
+ *   from PixelBuffer (ws2812_pixels.hpp, SDK-free); this class is the PIO/DMA
+ *   transport around it.
  *
  * Threading:
  * - Not re-entrant. Don’t call from multiple contexts simultaneously.
+ * - To render on core 0 and pack/transmit on core 1, hand the strip to a
+ *   Core1Driver (ws2812_core1.hpp); core 1 then owns it.
  */
-class Strip {
+class Strip : public PixelBuffer {
 public:
+    /**
+     * @brief Bit timing in PIO cycles; one bit is t1 + t2 + t3 cycles at the
+     * data rate given to the constructor.
+     *
+     * A 1 bit is high for t1 + t2 and low for t3, a 0 bit high for t1 and low
+     * for t2 + t3. Each phase is 1..16 cycles. The default 2/5/3 at 800 kHz is
+     * T0H 250 ns, T1H 875 ns, 1.25 µs per bit; e.g. {3, 4, 3} moves T0H and
+     * T1H to 375/875 ns for WS2815-style chips.
+     */
+    struct Timing { uint8_t t1 = 2, t2 = 5, t3 = 3; };
+
+    /**
+     * @brief Optional features selected at begin().
+     */
+    struct Options {
+        /// Two staging buffers: showAsync() packs frame N+1 while DMA streams
+        /// frame N. Costs another staging buffer (3-4 bytes per LED).
+        bool double_buffer = false;
+        /// Stage frames as a G,R,B[,W] byte stream (8-bit DMA, 8-bit autopull)
+        /// instead of one 32-bit word per LED: 3 instead of 4 bytes per LED
+        /// per staging buffer on RGB strips.
+        bool byte_wire = false;
+        /// Claim a second DMA channel as control-block sequencer so
+        /// showSegments() can chain up to this many segments into one frame
+        /// (0 = off). Needs 32-bit words, i.e. not with byte_wire.
+        uint max_segments = 0;
+        /// 16 bits per channel with temporal dithering in the packer: smooth
+        /// fades at low brightness, as long as frames keep being sent. Doubles
+        /// pixel RAM (plus 1 residual byte per channel); every show() repacks
+        /// all pixels. Best combined with double_buffer.
+        bool depth16 = false;
+        /// Fail begin() instead of falling back to blocking PIO writes when
+        /// no DMA channel is free.
+        bool require_dma = false;
+        /// Bit timing. Strips with different timing on one PIO block each
+        /// load their own copy of the program (4 instructions).
+        Timing timing = {};
+        /// Pixels per chunk for showChunked() and stream: two chunks of
+        /// staging plus one of RGBW scratch (~12 bytes per pixel), whatever
+        /// the LED count. 0 = showChunked() unavailable (64 with stream).
+        uint chunk_pixels = 0;
+        /// Stream show()/showAsync()/showFrom(RGB/RGBW) through the chunk
+        /// ring instead of packing whole frames into staging buffers: the
+        /// DMA completion IRQ refills each half just ahead of the wire, so
+        /// staging is O(1) in the LED count and the first bit goes out after
+        /// one chunk is packed. The pixel buffer is read until the last
+        /// chunk is packed: wait() before writing the next frame. Brightness,
+        /// gamma and white balance changes while a frame streams apply from
+        /// the next chunk packed. Not with double_buffer (nothing to gain) or
+        /// StripGroup (add() refuses it); showAt() sleeps until the deadline
+        /// and starts the stream from there.
+        bool stream = false;
+        /// false: no pixel buffer and no frame-sized staging buffer, so RAM
+        /// does not grow with the LED count. Frames then come only from
+        /// showChunked() and showFrom(const uint32_t*) (not with byte_wire);
+        /// setters, show() and showAsync() do nothing.
+        bool pixel_buffer = true;
+    };
+
     /**
      * @brief Construct a strip driver (no hardware setup yet).
      * @param pin   GPIO connected to the strip's DIN.
      * @param count Number of LEDs (valid indices: 0..count-1).
      * @param rgbw  true for SK6812 (GRBW, 32-bit), false for WS2812(B) (GRB, 24-bit).
      * @param freq  Data rate in Hz (default 800 kHz). 400 kHz works for some legacy strips.
-     * @param pio   PIO block (pio0/pio1).
+     * @param pio   PIO block (pio0/pio1, pio2 on RP2350).
      * @param sm    State machine index; -1 to auto-claim a free one.
+     * @param order Byte order on the wire (GRB for genuine WS2812/SK6812).
      *
-     * Call begin() before use.
+     * Call begin() before use. Links the packers for every colour order; a
+     * BasicStrip only pulls in its own.
      */
     Strip(uint pin, uint count, bool rgbw=false, float freq=800000.0f,
-          PIO pio=pio0, int sm=-1);
+          PIO pio=pio0, int sm=-1, ColorOrder order=ColorOrder::GRB);
+
+    /// @brief Calls end().
+    ~Strip();
 
     /**
      * @brief Initialize PIO (and DMA if enabled).
@@ -49,117 +123,453 @@ public:
      *
      * Configures pin directions, sideset, shifting, FIFO join, clock divider, etc.
      * Clears the internal buffer but does not send anything (call show()).
+     *
+     * The PIO program is loaded once per PIO block and shared (reference
+     * counted) by all strips on it. Nothing panics when resources run out:
+     * whatever was claimed is released again and false is returned. Calling
+     * it on a running strip re-initializes it (end() first).
      */
     bool begin();
 
+    /// @brief Initialize with optional features (see Options).
+    bool begin(const Options& opt);
+
     /**
-     * @brief Release SM/DMA (optional). Call begin() again to re-initialize.
+     * @brief Release SM/DMA and this strip's reference to the PIO program
+     * (removed with the last one). Call begin() again to re-initialize.
      */
     void end();
 
-    /// @brief Number of LEDs.
-    inline uint size() const { return _count; }
+    /// @brief true if begin() got a DMA channel; false means blocking sends.
+    inline bool hasDma() const { return _dma_ch >= 0; }
+
+    /**
+     * @brief Recompute the clock divider from the current clk_sys.
+     *
+     * The divider is derived from clk_sys at begin(); call this (or
+     * retimeAll()) after changing the system clock, between frames.
+     * @return false if not begun or the data rate is unreachable at this clock.
+     */
+    bool retime();
+
+    /// @brief retime() every begun Strip. @return false if any failed.
+    static bool retimeAll();
+
+    /**
+     * @brief Send the current buffer (blocking). Includes ≥80 µs reset latch.
+     *
+     * Only pixels changed since the staging buffer was last packed are
+     * repacked (a min/max range kept by setPixel()/setAll()/clear()); a
+     * brightness or gamma change repacks everything; an unchanged frame is
+     * re-sent without packing.
+     *
+     * Uses DMA if available, otherwise fills the PIO TX FIFO directly.
+     * Returns only after the frame is fully transmitted and the reset latch elapsed.
+     */
+    void show();
+
+    /**
+     * @brief Start sending asynchronously (non-blocking).
+     *
+     * Packs the buffer into the persistent staging buffer (allocated in begin())
+     * and returns as soon as DMA is armed; busy()/wait() track that transfer.
+     * With a single staging buffer, waits for a previous frame still in flight
+     * before packing. With Options::double_buffer the new frame is packed into
+     * the idle buffer first and only the DMA start waits for the previous frame.
+     * The pixel buffer itself may be modified freely right after this returns.
+     * Without a DMA channel this blocks until the last word is in the PIO FIFO.
+     */
+    void showAsync();
+
+    /**
+     * @brief showAsync() that never waits, for onFrameDone() callbacks (IRQ).
+     * @return false, sending nothing, while this strip is still busy().
+     *
+     * Packing still runs in the caller's context, and without a DMA channel
+     * so does the whole blocking send.
+     */
+    bool tryShowAsync();
 
     /**
-     * @brief Set the entire internal buffer to off (black). Does not send.
-     * @see show()
+     * @brief Pack now, start the transfer at `deadline` (non-blocking).
+     *
+     * Packing happens right away (waiting for the previous frame as
+     * showAsync() does); a hardware-timer alarm then starts DMA at the
+     * deadline, so the frame start does not depend on packing time. busy()
+     * and wait() include the scheduled start. Without a DMA channel this
+     * sleeps until the deadline and sends blocking.
+     * @return false if the deadline had already passed once packed: the frame
+     *         is sent immediately and counted in missedDeadlines().
      */
-    void clear();
+    bool showAt(absolute_time_t deadline);
 
     /**
-     * @brief Set all pixels (RGB) in the buffer.
-     * @param c Color (R,G,B). W remains 0 on RGBW strips.
+     * @brief Frame clock for showNextFrame(): frames start every 1/hz seconds.
+     * @param hz Frames per second; 0 turns the clock off.
+     *
+     * The period must cover the frame's wire time plus the 80 µs latch
+     * (30 µs per RGB pixel at 800 kHz: ~550 LEDs at 60 fps).
      */
-    void setAll(RGB c);
+    void setFrameRate(float hz);
 
     /**
-     * @brief Set all pixels (RGBW) in the buffer.
-     * @param c Color (R,G,B,W). W is ignored on WS2812.
+     * @brief showAt() the next tick of the frame clock (showAsync() if off).
+     *
+     * The first call starts the clock. After a missed tick the clock is
+     * re-anchored to the late frame instead of sending a burst to catch up.
+     * @return false if the tick was missed.
      */
-    void setAll(RGBW c);
+    bool showNextFrame();
+
+    /// @brief Deadlines showAt()/showNextFrame() could not meet since begin().
+    inline uint32_t missedDeadlines() const { return _missed; }
 
+#if WS2812_STATS
     /**
-     * @brief Set one pixel (RGB) in the buffer. Out-of-range indices are ignored.
-     * @param i Pixel index [0..size()-1].
-     * @param c Color.
+     * @brief Hot-path counters since begin() or resetStats() (WS2812_STATS=1).
+     *
+     * Plain fields updated in thread context (frame starts from showAt() in
+     * the alarm IRQ); copy the struct out before reporting.
      */
-    void setPixel(uint i, RGB c);
+    struct Stats {
+        uint32_t frames = 0;          ///< frames started
+        uint32_t blocking_frames = 0; ///< of those, sent without DMA
+        uint32_t overlapped = 0;      ///< sends issued while the previous frame was still busy
+        uint64_t pack_us = 0;         ///< total time in build_frame (chunks included)
+        uint64_t wait_us = 0;         ///< total time blocked in wait()
+        uint32_t max_interval_us = 0; ///< longest frame start to frame start
+        uint64_t interval_sum_us = 0; ///< sum of the frames - 1 intervals
+
+        /// Mean frame start to frame start, 0 before the second frame.
+        inline uint32_t avg_interval_us() const {
+            return frames > 1 ? (uint32_t)(interval_sum_us / (frames - 1)) : 0;
+        }
+    };
 
-    /// @brief Set one pixel (RGB) in the buffer.
-    void setPixel(uint i, uint8_t r, uint8_t g, uint8_t b);
+    /// @brief Counters (see Stats).
+    inline const Stats& stats() const { return _stats; }
 
-    /// @brief Set one pixel (RGBW) in the buffer.
-    void setPixel(uint i, RGBW c);
+    /// @brief Zero all counters.
+    inline void resetStats() { _stats = Stats{}; }
+#endif
 
     /**
-     * @brief Global brightness [0..255]. Applied when sending.
+     * @brief Packed staging buffer the next frame is sent from (size() words).
+     *
+     * Words are in wire format, first byte in bits 31..24: 0xGGRRBB00 on GRB
+     * strips, 0xGGRRBBWW on GRBW (other colour orders permute the top three bytes).
+     * Fill it (or use setPixelRaw()) and call showRaw() to send it without
+     * build_frame, i.e. without brightness/gamma. Single-buffered, it is the
+     * buffer DMA reads, so wait() before writing. With Options::double_buffer
+     * it is the idle buffer and alternates after every send, holding whatever
+     * was sent two frames earlier.
+     * @return nullptr before begin() or with Options::byte_wire.
      */
-    void setBrightness(uint8_t b);
+    uint32_t* wireBuffer();
 
     /**
-     * @brief Enable/disable ~2.2 gamma correction (sRGB-ish) via an 8-bit LUT.
+     * @brief Write one pre-packed wire word (see wireBuffer()) into the staging buffer.
+     *
+     * Works with byte_wire too. Out-of-range indices are ignored.
      */
-    void enableGamma(bool on);
+    void setPixelRaw(uint i, uint32_t word);
 
     /**
-     * @brief Send the current buffer (blocking). Includes ≥80 µs reset latch.
+     * @brief Send the staging buffer as is (non-blocking, like showAsync()).
      *
-     * Uses DMA if available, otherwise fills the PIO TX FIFO directly.
-     * Returns only after the frame is fully transmitted and the reset latch elapsed.
+     * Skips build_frame entirely: no pass over the pixel buffer and no
+     * brightness/gamma. Waits only for a previous frame still in flight.
      */
-    void show();
+    void showRaw();
 
     /**
-     * @brief Start sending asynchronously (non-blocking).
+     * @brief Pack and send pixels from caller memory, bypassing the internal buffer.
+     * @param src R,G,B (or R,G,B,W) pixels; W is ignored on RGB strips and 0 on
+     *            RGBW strips fed RGB.
+     * @param n   Pixels to send (clamped to size()); a shorter frame leaves the
+     *            LEDs past n unchanged.
      *
-     * Important: call wait() or poll busy() before starting another frame or
-     * making disruptive changes. A persistent internal staging buffer is used
-     * to hold the packed 24/32-bit words while DMA/PIO transfers.
+     * Non-blocking like showAsync(): brightness/gamma are applied while packing
+     * straight into the staging buffer, so src may be reused once this returns.
+     * The internal pixel buffer is neither read nor modified.
      */
-    void showAsync();
+    void showFrom(const RGB* src, size_t n);
+    void showFrom(const RGBW* src, size_t n);
 
     /**
-     * @brief true while a transfer is in flight (DMA/PIO).
+     * @brief Send pre-packed wire words (see wireBuffer()) straight from caller memory.
+     *
+     * Zero-copy: DMA reads `words` directly, so the buffer must stay valid and
+     * unmodified until busy() returns false (or onFrameDone fires). No
+     * brightness/gamma. With Options::byte_wire the words are unpacked into
+     * the staging buffer first (one copy) and may be reused on return.
+     */
+    void showFrom(const uint32_t* words, size_t n);
+
+    /**
+     * @brief Send a frame expanded from a pixel source one chunk at a time.
+     * @return false without Options::chunk_pixels (or before begin()).
+     *
+     * The frame never exists in RAM as a whole: the source fills
+     * Options::chunk_pixels LEDs at a time, each chunk is packed (brightness,
+     * gamma, power estimate) into one half of a two-chunk staging ring and
+     * sent while the next is being filled. With DMA this returns once the
+     * first chunk is on its way; the DMA IRQ then calls the source for the
+     * rest, so it must be IRQ-safe and its data stay valid until busy() is
+     * false. Without DMA it returns once the last chunk is started.
+     *
+     * Filling and packing a chunk must take less than its wire time (30 µs
+     * per RGB LED at 800 kHz) plus the 8-word FIFO, or the line idles long
+     * enough to latch mid-frame: keep the source cheap and interrupts short.
+     */
+    bool showChunked(PixelSourceFn src, void* ctx);
+
+    /// @brief showChunked() from any frame with `expand(first, n, RGBW*) const`
+    /// (PaletteFrame, RleFrame in ws2812_frame.hpp) of at least size() LEDs.
+    template<class Frame>
+    inline bool showChunked(const Frame& f) {
+        return showChunked([](void* c, uint first, uint n, RGBW* out) {
+            static_cast<const Frame*>(c)->expand(first, n, out);
+        }, const_cast<Frame*>(&f));
+    }
+
+    /**
+     * @brief Send a scatter list of packed-word segments back-to-back as one frame.
+     *
+     * A control DMA channel (Options::max_segments) loads each segment into the
+     * data channel in turn, without CPU involvement and without gaps on the
+     * wire: zone buffers in separate allocations, a shared background with an
+     * overlay window, or frames no single allocation can hold.
+     * Non-blocking; every segment must stay valid until busy() returns false.
+     * @return false without a control channel, with more than max_segments
+     *         segments or more words than size().
+     */
+    bool showSegments(const WireSegment* segs, size_t n);
+
+    /**
+     * @brief true while a frame is in flight or latching.
+     *
+     * Covers the DMA transfer, the PIO FIFO draining onto the wire and the
+     * ≥80 µs reset latch after the last bit, so false means it is safe to send.
      */
     bool busy() const;
 
     /**
      * @brief Block until the transfer finishes and the reset latch elapsed.
+     *
+     * Only sleeps for whatever part of the wire time and latch has not already
+     * passed; returns immediately if nothing was sent since the last wait().
      */
     void wait();
 
+    /// Frame-done callback; runs in interrupt context (timer alarm).
+    using FrameDoneFn = void (*)(Strip& strip, void* ctx);
+
     /**
-     * @brief Utility: HSV → RGB (H: 0..360, S/V: 0..1).
+     * @brief Call cb after each frame's transfer and reset latch completed.
+     * @param cb      Callback, or nullptr to detach. Runs in IRQ context: keep it
+     *                short. It may start the next frame of this or another strip
+     *                with tryShowAsync(), but must not call anything that waits
+     *                (show(), showAsync(), wait()): the frame it waits for may
+     *                need this IRQ to finish.
+     * @param ctx     Passed through to cb.
+     * @param dma_irq Shared DMA IRQ line for this strip's channel (0 or 1).
+     * @return false if dma_irq is out of range.
+     *
+     * Call after begin(). A shared handler is installed on DMA_IRQ_0/1; on DMA
+     * completion a one-shot alarm is armed for the latch deadline. Without a DMA
+     * channel the alarm is armed when the blocking send returns.
      */
-    static RGB hsv(float h, float s, float v);
+    bool onFrameDone(FrameDoneFn cb, void* ctx = nullptr, uint dma_irq = 0);
+
+protected:
+    /// For BasicStrip: packers fixed at compile time.
+    Strip(uint pin, uint count, bool rgbw, float freq, PIO pio, int sm,
+          const detail::PackKernels* kern);
 
 private:
-    /// Build packed GRB/GRBW 32-bit words for transmission.
-    void build_frame(std::vector<uint32_t>& out);
+    /// Clock divider for _freq and _timing at the current clk_sys (< 1: too fast).
+    float clkdiv() const;
+
+    /// Start DMA/PIO transfer of `units` words (bytes with byte_wire); blocking without DMA.
+    void start_dma(const uint32_t* data, size_t units);
+
+    /// Wait as needed and pack _buf (or src) into the back staging buffer
+    /// (false if not begun or without staging buffers).
+    bool pack_frame();
+    bool pack_frame(const uint8_t* src, uint stride, uint n);
+
+    /// Start sending `pixels` of the back staging buffer; flips buffers if double-buffered.
+    void send_frame(size_t pixels);
 
-    /// Start DMA/PIO transfer from the given word buffer.
-    void start_dma(const uint32_t* data, size_t words);
+    /// Start a frame of `units` DMA transfers (`pixels` LEDs) from data.
+    void send(const uint32_t* data, size_t units, size_t pixels);
+
+    /// showFrom(const uint32_t*) for timer/IRQ callers that found !busy():
+    /// never waits or sleeps.
+    void send_from_irq(const uint32_t* words, size_t n);
+
+    /// Record that a frame of `pixels` starts now: latch deadline and stats.
+    void mark_sent(size_t pixels);
+    /// Just the latch deadline (re-anchoring a frame already counted). Returns now.
+    absolute_time_t set_latch(size_t pixels);
 
     /// Abort ongoing DMA (if any).
     void stop_dma();
 
-    uint            _pin, _count;
-    bool            _rgbw;
+    /// True while the data (or control) DMA channel is still running.
+    bool dma_busy() const;
+
+    /// Control-block chaining for showSegments().
+    struct ControlBlock { uint32_t count; const void* read_addr; }; // = alias-3 register order
+    void setup_chain(uint max_segments);
+    void set_chained(bool on);
+
+    /// Chunked transmission (showChunked(), Options::stream): wait(), set
+    /// the source in _st_*, then stream_start() packs and sends the first
+    /// chunk; the DMA IRQ (stream_irq()) sends and refills the rest.
+    void stream_start(uint pixels);
+    void stream_own();
+    void stream_from(const uint8_t* src, uint stride, size_t n);
+    void stream_fill(uint k);
+    void stream_send(uint k);
+    void stream_irq();
+
+    /// Frame-done plumbing: shared DMA IRQ handlers and the latch alarm.
+    bool attach_irq(uint dma_irq);
+    void detach_irq();
+    void arm_done_alarm();
+    static void irq_service(uint irq);
+    static void dma_irq0();
+    static void dma_irq1();
+    static int64_t latch_alarm(alarm_id_t id, void* user);
+
+    /// Alarm for showAt(): starts the transfer prepared in _sched_*.
+    static int64_t start_alarm(alarm_id_t id, void* user);
+
+    uint            _pin;
     float           _freq;
     PIO             _pio;
-    int             _sm;
+    int             _sm;            // claimed SM, -1 if none
+    int             _sm_req;        // SM asked for in the constructor, -1 = any
     int             _dma_ch;        // -1 if none
+    int             _ctrl_ch = -1;  // control-block sequencer for showSegments(), -1 if none
+    bool            _chained = false; // data channel currently set up for chaining
+    std::vector<ControlBlock> _cblocks; // segment list + null terminator
     uint            _pio_offset;    // PIO program offset
+    bool            _prog_loaded = false; // holding a program reference
+    Timing          _timing = {};
+    Strip*          _next_active = nullptr; // begun strips, for retimeAll()
 
-    std::vector<RGBW>     _buf;       // logical pixel buffer (RGBW)
-    std::vector<uint32_t> _frame_tx;  // persistent TX staging buffer (packed words)
-    uint8_t         _brightness;      // 0..255
-    bool            _gamma_on;
-    uint8_t         _gam[256];        // gamma LUT
-    bool            _tx_in_flight = false; // DMA active?
+    std::vector<uint32_t> _frame_tx[2]; // persistent TX staging buffers (packed words), empty without pixel_buffer
+    std::vector<uint32_t> _chunk_tx[2]; // showChunked()/stream staging ring
+    std::vector<RGBW> _chunk_px;        // showChunked() source scratch
+    bool            _stream = false;    // Options::stream
+    PixelSourceFn   _st_fn = nullptr;   // chunk source, or nullptr: pack _st_src directly
+    void*           _st_ctx = nullptr;
+    const uint8_t*  _st_src = nullptr;  // pixels (stride _st_stride), or _buf16 with _st_16
+    uint            _st_stride = 0;
+    bool            _st_16 = false;
+    uint            _st_count = 0;      // pixels in the streamed frame
+    volatile uint   _st_next = 0;       // first pixel not yet packed
+    volatile uint   _st_n[2] = {0, 0};  // pixels packed into each half, 0 = empty
+    volatile uint8_t _st_cur = 0;       // half DMA is sending
+    volatile bool   _streaming = false; // chunks still to be sent
+    uint32_t        _st_sum = 0;        // channel sum for the power estimate
+    bool            _st_sum_pending = false;
+    uint8_t         _tx_back = 0;     // staging buffer packed by the next frame
+    bool            _double_buf = false;
+    size_t          _tx_units = 0;      // DMA transfers per frame
+    bool            _tx_in_flight = false; // frame sent, wait() not yet done?
+    uint32_t        _word_ns = 30000;      // wire time of one pixel word
+    absolute_time_t _latch_until = {};     // last bit out + reset latch
+
+    FrameDoneFn     _done_cb = nullptr;
+    void*           _done_ctx = nullptr;
+    int8_t          _dma_irq = -1;         // DMA_IRQ_n used for frame-done, -1 if none
+    volatile alarm_id_t _done_alarm = 0;   // pending latch alarm
+
+    volatile bool   _start_pending = false; // showAt() frame not started yet
+    alarm_id_t      _start_alarm = 0;
+    const uint32_t* _sched_data = nullptr;  // what start_alarm sends
+    size_t          _sched_units = 0, _sched_pixels = 0;
+    uint32_t        _frame_us = 0;          // frame clock period, 0 = off
+    absolute_time_t _frame_tick = nil_time; // last tick of the frame clock
+    uint32_t        _missed = 0;
+#if WS2812_STATS
+    Stats           _stats;
+    uint64_t        _last_start_us = 0;     // previous frame start, for intervals
+#endif
 
     Strip(const Strip&) = delete;
     Strip& operator=(const Strip&) = delete;
+
+    friend class StripGroup;
+    friend class Player;
+};
+
+/**
+ * @brief Strip whose colour order and pixel format are fixed at compile time.
+ *
+ * The packers are instantiated for exactly this Order/RGBW pair: constant
+ * shifts, no per-pixel branches, and only these kernels end up in flash.
+ * Brightness and gamma live in one LUT either way. Otherwise a plain Strip,
+ * so it works with StripGroup, Core1Driver and anything taking a Strip&.
+ *
+ * @code
+ * ws::BasicStrip<ws::order::BRG> clone(2, 60);
+ * ws::BasicStrip<ws::order::GRB, true> sk6812(3, 144);
+ * @endcode
+ */
+template<class Order = order::GRB, bool RGBW = false>
+class BasicStrip : public Strip {
+public:
+    BasicStrip(uint pin, uint count, float freq=800000.0f, PIO pio=pio0, int sm=-1)
+    : Strip(pin, count, RGBW, freq, pio, sm, detail::pack_kernels<Order, RGBW>()) {}
+
+    static constexpr ColorOrder color_order = Order::id;
+};
+
+/**
+ * @brief Sends the frames of several Strips in parallel.
+ *
+ * Each member keeps its own SM, DMA channel, buffer and settings; the group
+ * only coordinates the start. On showAsync() all members are packed first,
+ * their SMs are stopped while DMA prefills the FIFOs, and then released with
+ * pio_enable_sm_mask_in_sync() so the frames go out bit-aligned per PIO block
+ * (pio0 and pio1 start back-to-back). The whole group then takes one frame
+ * time of its longest member instead of the sum.
+ *
+ * Members without a DMA channel are sent afterwards, blocking, one by one.
+ * Members must have been begun, with a frame staging buffer (not
+ * Options::stream or pixel_buffer = false), and must outlive the group.
+ */
+class StripGroup {
+public:
+    static constexpr uint MAX_STRIPS = 8;
+
+    /// @brief Add a strip. false if the group is full, s is already a member,
+    /// or s is not begun or has no staging buffer to pack into.
+    bool add(Strip& s);
+
+    /// @brief Number of member strips.
+    inline uint size() const { return _n; }
+
+    /// @brief Pack all members and start them together (non-blocking).
+    void showAsync();
+
+    /// @brief showAsync() + wait().
+    void show();
+
+    /// @brief true while any member's frame is in flight or latching.
+    bool busy() const;
+
+    /// @brief Block until every member finished its frame and reset latch.
+    void wait();
+
+private:
+    Strip* _strips[MAX_STRIPS] = {};
+    uint   _n = 0;
 };
 
 } // namespace ws
@@ -0,0 +1,78 @@
+#include "ws2812_adalight.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ws {
+
+AdalightParser::AdalightParser(uint max_pixels, FrameFn fn, void* ctx)
+: _fn(fn), _ctx(ctx), _frame((size_t)max_pixels * sizeof(RGB)) {}
+
+void AdalightParser::reset() {
+    _state = State::Header;
+    _hdr_n = 0;
+    _got = 0;
+}
+
+size_t AdalightParser::consume(const uint8_t* p, size_t n, size_t room) {
+    const uint8_t* const start = p;
+    const uint8_t* const end = p + n;
+    while (p < end) {
+        switch (_state) {
+        case State::Header:
+            header_byte(*p++);
+            break;
+        case State::Payload: {
+            size_t want = _keep - _got, have = (size_t)(end - p);
+            if (_got == 0 && have >= want) {
+                deliver(p); // whole payload in place: pack straight from it
+                p += want;
+            } else if (_got == 0 && want <= room - (size_t)(p - start)) {
+                return (size_t)(p - start); // the rest lands contiguously: wait for it
+            } else {
+                size_t c = std::min(have, want);
+                std::memcpy(&_frame[_got], p, c);
+                p += c;
+                _got += (uint32_t)c;
+                if (_got == _keep) deliver(_frame.data());
+            }
+            break;
+        }
+        case State::Skip: {
+            size_t c = std::min((size_t)(end - p), (size_t)_skip);
+            p += c;
+            _skip -= (uint32_t)c;
+            if (!_skip) _state = State::Header;
+            break;
+        }
+        }
+    }
+    return n;
+}
+
+void AdalightParser::header_byte(uint8_t b) {
+    static constexpr uint8_t MAGIC[3] = {'A', 'd', 'a'};
+    if (_hdr_n < 3 && b != MAGIC[_hdr_n]) {
+        _hdr_n = (b == MAGIC[0]) ? 1 : 0;
+        return;
+    }
+    _hdr[_hdr_n++] = b;
+    if (_hdr_n < 6) return;
+    _hdr_n = 0;
+    if ((uint8_t)(_hdr[3] ^ _hdr[4] ^ 0x55) != _hdr[5]) { ++_errors; return; }
+
+    uint32_t bytes = (((uint32_t)_hdr[3] << 8 | _hdr[4]) + 1) * (uint32_t)sizeof(RGB);
+    _keep = std::min(bytes, (uint32_t)_frame.size());
+    _skip = bytes - _keep;
+    _got = 0;
+    _state = _keep ? State::Payload : State::Skip;
+}
+
+void AdalightParser::deliver(const uint8_t* rgb) {
+    _fn(_ctx, reinterpret_cast<const RGB*>(rgb), _keep / (uint32_t)sizeof(RGB));
+    ++_frames;
+    _got = 0;
+    _state = _skip ? State::Skip : State::Header;
+}
+
+} // namespace ws
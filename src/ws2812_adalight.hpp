@@ -0,0 +1,69 @@
+#pragma once
+// Adalight frame parser behind StreamSource. SDK-free.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ws2812_pixels.hpp"
+
+namespace ws {
+
+/**
+ * @brief Incremental Adalight parser: bytes in, complete RGB frames out.
+ *
+ * Frame format: "Ada", count hi, count lo, hi ^ lo ^ 0x55, then (count + 1)
+ * R,G,B triplets. Only the 6 header bytes are parsed one by one; a payload
+ * that arrives whole (or is known to land contiguously, see consume()) is
+ * handed to the callback in place, one split across chunks is first copied
+ * into an internal frame buffer.
+ *
+ * Frames longer than max_pixels are cut to size; bytes past it are skipped.
+ * A bad header checksum drops the frame and resynchronizes on the next "Ada".
+ */
+class AdalightParser {
+public:
+    /// Called with each completed frame; px is valid only during the call.
+    using FrameFn = void (*)(void* ctx, const RGB* px, uint n);
+
+    /// @param max_pixels Longest frame kept (usually the strip's size()).
+    AdalightParser(uint max_pixels, FrameFn fn, void* ctx = nullptr);
+
+    /**
+     * @brief Parse n bytes at p.
+     * @param room Bytes from p that are contiguous and stay valid (n for a
+     *             plain chunk; up to the end of a ring buffer), so a payload
+     *             that fits may be left in place until it is complete.
+     * @return Bytes used: < n only when waiting like that; pass the rest again.
+     */
+    size_t consume(const uint8_t* p, size_t n, size_t room);
+
+    /// @brief consume() of a chunk that may be reused on return.
+    inline void feed(const uint8_t* p, size_t n) { consume(p, n, n); }
+
+    /// @brief Drop any partial frame and wait for the next header.
+    void reset();
+
+    /// @brief Frames delivered since construction.
+    inline uint32_t frames() const { return _frames; }
+
+    /// @brief Headers rejected for a bad checksum.
+    inline uint32_t errors() const { return _errors; }
+
+private:
+    enum class State : uint8_t { Header, Payload, Skip };
+
+    void header_byte(uint8_t b);
+    void deliver(const uint8_t* rgb);
+
+    FrameFn              _fn;
+    void*                _ctx;
+    std::vector<uint8_t> _frame;          // assembly buffer for split frames (max_pixels RGB)
+    State                _state = State::Header;
+    uint8_t              _hdr[6];
+    uint8_t              _hdr_n = 0;
+    uint32_t             _keep = 0;       // payload bytes that fit max_pixels
+    uint32_t             _skip = 0;       // payload bytes past it
+    uint32_t             _got = 0;        // bytes of _keep assembled in _frame
+    uint32_t             _frames = 0, _errors = 0;
+};
+
+} // namespace ws
@@ -0,0 +1,68 @@
+#include "ws2812_capture.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace ws {
+
+CaptureStrip::CaptureStrip(uint count, bool rgbw, ColorOrder order)
+: PixelBuffer(count, rgbw, order)
+{
+    begin();
+}
+
+void CaptureStrip::begin() { begin(Options{}); }
+
+void CaptureStrip::begin(const Options& opt) {
+    _byte_wire = opt.byte_wire;
+    set_depth16(opt.depth16);
+    const size_t units = _byte_wire ? (size_t)_count * _bpp : _count;
+    _stage.assign(_byte_wire ? (units + 3) / 4 : units, 0u);
+    _frames.clear();
+    clear(); // also marks the staging buffer for a full repack
+}
+
+void CaptureStrip::show() {
+    if (needs_pack(0)) pack_dirty(_stage.data(), 0);
+    capture(_count);
+}
+
+void CaptureStrip::showFrom(const RGB* src, size_t n) {
+    n = std::min(n, (size_t)_count);
+    pack_from(_stage.data(), 0, reinterpret_cast<const uint8_t*>(src), 3, (uint)n);
+    capture(n);
+}
+
+void CaptureStrip::showFrom(const RGBW* src, size_t n) {
+    n = std::min(n, (size_t)_count);
+    pack_from(_stage.data(), 0, reinterpret_cast<const uint8_t*>(src), 4, (uint)n);
+    capture(n);
+}
+
+void CaptureStrip::showChunked(PixelSourceFn src, void* ctx, uint chunk_pixels) {
+    // Same chunking as the Strip; the chunks just land side by side.
+    std::vector<RGBW> px(std::max(1u, std::min(chunk_pixels, _count)));
+    uint32_t sum = 0;
+    for (uint first = 0; first < _count;) {
+        const uint n = std::min((uint)px.size(), _count - first);
+        src(ctx, first, n, px.data());
+        sum += build_frame(_stage.data(), first, reinterpret_cast<const uint8_t*>(px.data()), 4, n);
+        first += n;
+    }
+    limit_power(sum);
+    _dirty_lo[0] = 0; _dirty_hi[0] = _count; // _stage no longer mirrors _buf
+    capture(_count);
+}
+
+void CaptureStrip::capture(size_t pixels) {
+    if (!_byte_wire) {
+        _frames.emplace_back(_stage.begin(), _stage.begin() + pixels);
+        return;
+    }
+    // 8-bit autopull shifts out bits 31..24 of each FIFO entry.
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(_stage.data());
+    std::vector<uint32_t> f(pixels * _bpp);
+    for (size_t i=0;i<f.size();++i) f[i] = uint32_t(b[i]) << 24;
+    _frames.push_back(std::move(f));
+}
+
+} // namespace ws
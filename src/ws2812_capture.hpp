@@ -0,0 +1,64 @@
+#pragma once
+// Host transport: records packed frames instead of sending them. SDK-free.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ws2812_pixels.hpp"
+
+namespace ws {
+
+/**
+ * @brief PixelBuffer whose "wire" is a list of captured frames.
+ *
+ * Runs the same packer, dirty-range tracking, dithering and power limiter as
+ * Strip, so a captured frame is exactly the word stream the PIO TX FIFO
+ * would receive: one word per pixel (0xGGRRBB00 / 0xGGRRBBWW for GRB[W]),
+ * or with byte_wire one word per byte with the byte in bits 31..24. Meant for
+ * golden-frame comparisons, sanitizers and profiling on a workstation
+ * (WS2812_HOST build).
+ */
+class CaptureStrip : public PixelBuffer {
+public:
+    /// Subset of Strip::Options that changes the packed stream.
+    struct Options {
+        bool byte_wire = false;
+        bool depth16 = false;
+    };
+
+    CaptureStrip(uint count, bool rgbw=false, ColorOrder order=ColorOrder::GRB);
+
+    /// @brief Select the wire format and pixel depth; clears pixels and captures.
+    void begin();
+    void begin(const Options& opt);
+
+    /// @brief Pack the buffer (changed pixels only, as Strip::show()) and capture the frame.
+    void show();
+
+    /// @brief Pack and capture pixels from caller memory (as Strip::showFrom()).
+    void showFrom(const RGB* src, size_t n);
+    void showFrom(const RGBW* src, size_t n);
+
+    /// @brief Pack and capture a frame from a chunked source (as Strip::showChunked()).
+    void showChunked(PixelSourceFn src, void* ctx, uint chunk_pixels = 64);
+
+    template<class Frame>
+    inline void showChunked(const Frame& f, uint chunk_pixels = 64) {
+        showChunked([](void* c, uint first, uint n, RGBW* out) {
+            static_cast<const Frame*>(c)->expand(first, n, out);
+        }, const_cast<Frame*>(&f), chunk_pixels);
+    }
+
+    /// @brief Every frame captured so far, oldest first.
+    inline const std::vector<std::vector<uint32_t>>& frames() const { return _frames; }
+
+    /// @brief Drop the captured frames (keeps the staging buffer).
+    inline void clearFrames() { _frames.clear(); }
+
+private:
+    void capture(size_t pixels);
+
+    std::vector<uint32_t> _stage;   // staging buffer, as Strip::_frame_tx[0]
+    std::vector<std::vector<uint32_t>> _frames;
+};
+
+} // namespace ws
@@ -0,0 +1,76 @@
+#include "ws2812_core1.hpp"
+
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+
+namespace ws {
+
+static bool s_core1_in_use = false; // only touched from core 0
+static constexpr uint32_t CORE1_STOPPED = 0x57534450u; // FIFO token: loop exited
+
+Core1Driver::Core1Driver(Strip& strip, uint frames)
+: _strip(strip), _frames(frames < 2 ? 2 : frames > MAX_FRAMES ? MAX_FRAMES : frames) {}
+
+Core1Driver::~Core1Driver() { stop(); }
+
+bool Core1Driver::start() {
+    if (_run.load()) return true;
+    if (s_core1_in_use) return false;
+    s_core1_in_use = true;
+
+    _pool.assign((size_t)_frames * _strip.size(), RGBW{0,0,0,0});
+    RGBW* f;
+    while (_free.pop(f)) {}
+    while (_submitted.pop(f)) {}
+    for (uint i=0;i<_frames;++i) _free.push(&_pool[(size_t)i * _strip.size()]);
+
+    _run.store(true);
+    multicore_launch_core1(core1_entry);
+    multicore_fifo_push_blocking((uint32_t)(uintptr_t)this); // core 1 learns its driver
+    return true;
+}
+
+void Core1Driver::stop() {
+    if (!_run.load()) return;
+    _run.store(false);
+    __sev();
+    while (multicore_fifo_pop_blocking() != CORE1_STOPPED) {}
+    multicore_reset_core1();
+    _strip.wait();
+    s_core1_in_use = false;
+}
+
+RGBW* Core1Driver::acquire(bool block) {
+    RGBW* f = nullptr;
+    while (!_free.pop(f)) {
+        if (!block || !_run.load()) return nullptr;
+        __wfe(); // core 1 signals after every release
+    }
+    return f;
+}
+
+void Core1Driver::submit(RGBW* frame) {
+    if (!frame) return;
+    _submitted.push(frame); // cannot be full: at most _frames buffers exist
+    __sev();
+}
+
+void Core1Driver::core1_entry() {
+    Core1Driver* self = (Core1Driver*)(uintptr_t)multicore_fifo_pop_blocking();
+    self->core1_loop();
+    multicore_fifo_push_blocking(CORE1_STOPPED);
+}
+
+void Core1Driver::core1_loop() {
+    const size_t n = _strip.size();
+    while (_run.load(std::memory_order_relaxed)) {
+        RGBW* f;
+        if (!_submitted.pop(f)) { __wfe(); continue; }
+        // Packed into the strip's staging buffer here; DMA runs on.
+        _strip.showFrom(f, n);
+        _free.push(f);
+        __sev();
+    }
+}
+
+} // namespace ws
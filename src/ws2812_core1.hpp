@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ws2812.hpp"
+
+namespace ws {
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of N items (N a power of two).
+ *
+ * One context may push and one other context (e.g. the other core) may pop,
+ * without locks or disabling interrupts. Only atomic loads/stores are used,
+ * which are lock-free on Cortex-M0+.
+ */
+template<class T, uint N>
+class SpscQueue {
+    static_assert(N && (N & (N - 1)) == 0, "N must be a power of two");
+public:
+    /// @brief Append v. false if full.
+    bool push(const T& v) {
+        uint32_t h = _head.load(std::memory_order_relaxed);
+        if (h - _tail.load(std::memory_order_acquire) == N) return false;
+        _items[h & (N - 1)] = v;
+        _head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Remove the oldest item into v. false if empty.
+    bool pop(T& v) {
+        uint32_t t = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == t) return false;
+        v = _items[t & (N - 1)];
+        _tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Items currently queued (a snapshot when called from either side).
+    uint size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T _items[N];
+    std::atomic<uint32_t> _head{0}, _tail{0};
+};
+
+/**
+ * @brief Runs a Strip's packing and transmission on core 1.
+ *
+ * Core 0 renders into frame buffers taken from a small pool (acquire()) and
+ * hands them over with submit(); core 1 packs each submitted frame with
+ * Strip::showFrom() and returns the buffer to the pool as soon as it is packed.
+ * Both directions are SpscQueues, so neither core ever takes a lock; the
+ * inter-core FIFO is only used for the start/stop handshake.
+ *
+ * Combine with Strip::Options::double_buffer so core 1 packs frame N+1 while
+ * frame N is on the wire.
+ *
+ * Threading:
+ * - While running, core 1 owns the strip: core 0 must not call the strip's
+ *   setter/show methods, setBrightness() or enableGamma().
+ * - Only one Core1Driver can run at a time (core 1 is launched by start()).
+ */
+class Core1Driver {
+public:
+    static constexpr uint MAX_FRAMES = 4;
+
+    /**
+     * @param strip  A begun Strip; must outlive the driver.
+     * @param frames Frame buffers in the pool (2..MAX_FRAMES), size() RGBW pixels each.
+     */
+    explicit Core1Driver(Strip& strip, uint frames = 3);
+    ~Core1Driver();
+
+    /// @brief Allocate the pool and launch core 1. false if core 1 is already in use.
+    bool start();
+
+    /// @brief Let core 1 finish the frame in hand, then reset it.
+    void stop();
+
+    /**
+     * @brief Take a free frame buffer (strip.size() RGBW pixels) to render into.
+     * @param block Wait until core 1 releases one; otherwise return nullptr if
+     *              all buffers are queued or being packed.
+     */
+    RGBW* acquire(bool block = true);
+
+    /// @brief Queue a buffer from acquire() for transmission (frames go out in order).
+    void submit(RGBW* frame);
+
+    /// @brief Frames submitted but not yet packed by core 1.
+    inline uint pending() const { return _submitted.size(); }
+
+private:
+    static void core1_entry();
+    void core1_loop();
+
+    Strip&                   _strip;
+    uint                     _frames;
+    std::vector<RGBW>        _pool;
+    SpscQueue<RGBW*, MAX_FRAMES> _free;       // core 1 -> core 0
+    SpscQueue<RGBW*, MAX_FRAMES> _submitted;  // core 0 -> core 1
+    std::atomic<bool>        _run{false};
+
+    Core1Driver(const Core1Driver&) = delete;
+    Core1Driver& operator=(const Core1Driver&) = delete;
+};
+
+} // namespace ws
@@ -0,0 +1,30 @@
+#pragma once
+// Internal helpers shared by the drivers. Not part of the public API.
+#include <cstdint>
+
+namespace ws {
+namespace detail {
+
+/// Integer scale with rounding: (v*b)/255.
+static inline uint8_t scale_u8(uint8_t v, uint8_t b) {
+    return (uint8_t)((uint16_t(v) * (uint16_t)b + 127) / 255);
+}
+
+/// Fold brightness and a channel's white level into 16-bit gamma nodes:
+/// 8.8 fixed-point output, 0..255*256.
+static inline void combined_lut16(uint16_t lut[257], const uint16_t gam[257], uint8_t b, uint8_t wb = 255) {
+    for (int i=0;i<257;++i) {
+        uint32_t v = (uint32_t)gam[i] * b * 256u / 65535u;
+        lut[i] = (uint16_t)(wb == 255 ? v : v * wb / 255u);
+    }
+}
+
+/// Fold brightness and a channel's white level into a gamma table:
+/// lut[i] = round(gam[i] * b * wb / 255^2), scale_u8(gam[i], b) at wb 255.
+static inline void combined_lut(uint8_t lut[256], const uint8_t gam[256], uint8_t b, uint8_t wb = 255) {
+    const uint32_t s = (uint32_t)b * wb;
+    for (int i=0;i<256;++i) lut[i] = (uint8_t)((gam[i] * s + 32512u) / 65025u);
+}
+
+} // namespace detail
+} // namespace ws
@@ -0,0 +1,117 @@
+#include "ws2812_frame.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ws {
+
+PaletteFrame::PaletteFrame(uint count, uint bits)
+: _count(count), _nibbles(bits == 4),
+  _idx(_nibbles ? (count + 1) / 2 : count, 0),
+  _pal(_nibbles ? 16 : 256, RGBW{0, 0, 0, 0})
+{
+}
+
+void PaletteFrame::setColor(uint k, RGBW c) {
+    if (k < _pal.size()) _pal[k] = c;
+}
+
+void PaletteFrame::set(uint i, uint8_t k) {
+    if (i >= _count) return;
+    if (!_nibbles) { _idx[i] = k; return; }
+    uint8_t& b = _idx[i >> 1];
+    b = (i & 1) ? (uint8_t)((b & 0x0F) | (k << 4)) : (uint8_t)((b & 0xF0) | (k & 0x0F));
+}
+
+uint8_t PaletteFrame::get(uint i) const {
+    if (i >= _count) return 0;
+    if (!_nibbles) return _idx[i];
+    return (uint8_t)((_idx[i >> 1] >> ((i & 1) * 4)) & 0x0F);
+}
+
+void PaletteFrame::fill(uint first, uint n, uint8_t k) {
+    if (first >= _count) return;
+    uint last = first + std::min(n, _count - first);
+    if (!_nibbles) { std::memset(&_idx[first], k, last - first); return; }
+    // Odd edges one by one, whole bytes in between.
+    if (first < last && (first & 1)) set(first++, k);
+    if (first < last && (last & 1)) set(--last, k);
+    k &= 0x0F;
+    std::memset(&_idx[first >> 1], k | (k << 4), (last - first) >> 1);
+}
+
+void PaletteFrame::expand(uint first, uint n, RGBW* out) const {
+    if (first >= _count) return;
+    n = std::min(n, _count - first);
+    if (!n) return; // the odd-first nibble below would write out[0]
+    const RGBW* pal = _pal.data();
+    if (!_nibbles) {
+        const uint8_t* p = &_idx[first];
+        for (uint i=0;i<n;++i) out[i] = pal[p[i]];
+        return;
+    }
+    uint i = 0;
+    if (first & 1) out[i++] = pal[_idx[first >> 1] >> 4];
+    const uint8_t* p = &_idx[(first + i) >> 1];
+    for (; i + 1 < n; i += 2, ++p) {
+        out[i] = pal[*p & 0x0F];
+        out[i + 1] = pal[*p >> 4];
+    }
+    if (i < n) out[i] = pal[*p & 0x0F];
+}
+
+static inline bool same(const RGBW& a, const RGBW& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.w == b.w;
+}
+
+RleFrame::RleFrame(uint count) : _count(count) { clear(); }
+
+void RleFrame::clear(RGBW c) {
+    _runs.assign(1, Run{_count, c});
+}
+
+size_t RleFrame::find(uint i) const {
+    auto it = std::upper_bound(_runs.begin(), _runs.end(), i,
+                               [](uint v, const Run& r) { return v < r.end; });
+    return (size_t)(it - _runs.begin());
+}
+
+RGBW RleFrame::get(uint i) const {
+    return i < _count ? _runs[find(i)].color : RGBW{0, 0, 0, 0};
+}
+
+void RleFrame::fill(uint first, uint n, RGBW c) {
+    if (first >= _count || !n) return;
+    const uint32_t last = first + std::min(n, _count - first);
+    std::vector<Run> out;
+    out.reserve(_runs.size() + 2);
+    auto push = [&](uint32_t end, const RGBW& col) {
+        if (!out.empty() && same(out.back().color, col)) out.back().end = end;
+        else out.push_back(Run{end, col});
+    };
+    uint32_t start = 0;
+    bool placed = false;
+    for (const Run& r : _runs) {
+        if (r.end <= first) {
+            push(r.end, r.color);            // before the range
+        } else {
+            if (start < first) push(first, r.color); // head of the run the range starts in
+            if (!placed) { push(last, c); placed = true; }
+            if (r.end > last) push(r.end, r.color);  // after the range (or its tail)
+        }
+        start = r.end;
+    }
+    _runs.swap(out);
+}
+
+void RleFrame::expand(uint first, uint n, RGBW* out) const {
+    if (first >= _count) return;
+    n = std::min(n, _count - first);
+    size_t k = find(first);
+    for (uint i = 0; i < n; ++k) {
+        const uint run_end = std::min<uint32_t>(_runs[k].end, first + n) - first;
+        const RGBW c = _runs[k].color;
+        for (; i < run_end; ++i) out[i] = c;
+    }
+}
+
+} // namespace ws
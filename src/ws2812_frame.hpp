@@ -0,0 +1,95 @@
+#pragma once
+// Compact frame storage for Strip::showChunked(). SDK-free.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ws2812_pixels.hpp"
+
+namespace ws {
+
+/**
+ * @brief Frame of palette indices: 4 or 8 bits per LED instead of 3-4 bytes.
+ *
+ * 5000 LEDs take 2.5 KB at 4 bits (16 colours) or 5 KB at 8 bits (256
+ * colours), plus the palette. Sent with Strip::showChunked(), which expands
+ * one chunk at a time into the small staging ring; changing a palette entry
+ * recolours every LED using it without touching the indices.
+ */
+class PaletteFrame {
+public:
+    /// @param bits 4 or 8 (anything else is treated as 8). All LEDs start at index 0.
+    explicit PaletteFrame(uint count, uint bits = 8);
+
+    /// @brief Number of LEDs.
+    inline uint size() const { return _count; }
+
+    /// @brief Palette entries: 16 or 256.
+    inline uint colors() const { return (uint)_pal.size(); }
+
+    /// @brief Set palette entry k (ignored if out of range). All entries start black.
+    void setColor(uint k, RGBW c);
+    inline void setColor(uint k, RGB c) { setColor(k, RGBW{c.r, c.g, c.b, 0}); }
+    inline RGBW color(uint k) const { return k < _pal.size() ? _pal[k] : RGBW{0, 0, 0, 0}; }
+
+    /// @brief Set LED i to palette entry k (masked to the index width).
+    void set(uint i, uint8_t k);
+    uint8_t get(uint i) const;
+
+    /// @brief Set LEDs first..first+n-1 to palette entry k.
+    void fill(uint first, uint n, uint8_t k);
+
+    /// @brief Expand LEDs first..first+n-1 into out (the showChunked() source).
+    void expand(uint first, uint n, RGBW* out) const;
+
+private:
+    uint                 _count;
+    bool                 _nibbles;   // 4-bit indices, even LED in the low nibble
+    std::vector<uint8_t> _idx;
+    std::vector<RGBW>    _pal;
+};
+
+/**
+ * @brief Frame stored as runs of one colour: memory grows with the number of
+ * colour changes, not with the LED count.
+ *
+ * Meant for architectural runs of solid zones and gradients of few steps.
+ * fill() splits and merges runs as needed (neighbours of equal colour are
+ * joined); lookups are a binary search over the run ends, so expanding a
+ * chunk costs one search plus a linear walk.
+ */
+class RleFrame {
+public:
+    /// One run: LEDs from the previous run's end up to (excluding) `end`.
+    struct Run { uint32_t end; RGBW color; };
+
+    /// @brief All LEDs black: a single run.
+    explicit RleFrame(uint count);
+
+    /// @brief Number of LEDs.
+    inline uint size() const { return _count; }
+
+    /// @brief Set every LED to c (a single run).
+    void clear(RGBW c = RGBW{0, 0, 0, 0});
+
+    /// @brief Set LEDs first..first+n-1 to c.
+    void fill(uint first, uint n, RGBW c);
+    inline void fill(uint first, uint n, RGB c) { fill(first, n, RGBW{c.r, c.g, c.b, 0}); }
+
+    /// @brief Colour of LED i (black if out of range).
+    RGBW get(uint i) const;
+
+    /// @brief The runs, in LED order; the last one ends at size().
+    inline const std::vector<Run>& runs() const { return _runs; }
+
+    /// @brief Expand LEDs first..first+n-1 into out (the showChunked() source).
+    void expand(uint first, uint n, RGBW* out) const;
+
+private:
+    /// Index of the run holding LED i.
+    size_t find(uint i) const;
+
+    uint             _count;
+    std::vector<Run> _runs;
+};
+
+} // namespace ws
@@ -0,0 +1,70 @@
+#pragma once
+// Gamma tables generated at compile time. SDK-free.
+#include <cstdint>
+
+namespace ws {
+
+/**
+ * @brief One gamma curve, as 8-bit and 16-bit (Options::depth16) lookup tables.
+ *
+ * Build one with makeGamma() into a `static constexpr` object: it is computed
+ * by the compiler and lives in flash, and any number of strips can point at
+ * it (PixelBuffer::setGamma()). Only the combined per-strip packing table,
+ * with brightness and white balance folded in, is in RAM.
+ */
+struct GammaTable {
+    uint8_t  v8[256];  ///< 8-bit input -> 8-bit output
+    uint16_t v16[257]; ///< node k at input k*256 (the last clamps to 1.0), 16-bit output
+};
+
+namespace detail {
+
+// Double precision ln/exp for constant evaluation (no constexpr <cmath> in C++17).
+constexpr double LN2 = 0.6931471805599453;
+
+constexpr double cx_log(double x) {
+    int k = 0; // x = m * 2^k, m in [0.5, 1)
+    while (x >= 1.0) { x *= 0.5; ++k; }
+    while (x < 0.5)  { x *= 2.0; --k; }
+    // ln m = 2 atanh(z), |z| <= 1/3
+    double z = (x - 1.0) / (x + 1.0), z2 = z * z, t = z, s = 0.0;
+    for (int i = 1; i < 60; i += 2) { s += t / i; t *= z2; }
+    return 2.0 * s + k * LN2;
+}
+
+constexpr double cx_exp(double y) {
+    int n = 0; // y = n ln2 + r, r in [0, ln2)
+    while (y < 0.0)  { y += LN2; --n; }
+    while (y >= LN2) { y -= LN2; ++n; }
+    double s = 1.0, t = 1.0;
+    for (int i = 1; i < 25; ++i) { t *= y / i; s += t; }
+    for (; n > 0; --n) s *= 2.0;
+    for (; n < 0; ++n) s *= 0.5;
+    return s;
+}
+
+constexpr double cx_pow(double x, double g) {
+    return x <= 0.0 ? 0.0 : g == 1.0 ? x : cx_exp(g * cx_log(x));
+}
+
+} // namespace detail
+
+/// @brief Tables for out = in^gamma (1.0: identity).
+constexpr GammaTable makeGamma(double gamma) {
+    GammaTable t{};
+    for (int i = 0; i < 256; ++i)
+        t.v8[i] = (uint8_t)(detail::cx_pow(i / 255.0, gamma) * 255.0 + 0.5);
+    for (int i = 0; i < 257; ++i) {
+        double x = i * 256 / 65535.0;
+        t.v16[i] = (uint16_t)(detail::cx_pow(x < 1.0 ? x : 1.0, gamma) * 65535.0 + 0.5);
+    }
+    return t;
+}
+
+/// @brief Identity: no gamma correction.
+inline constexpr GammaTable GAMMA_LINEAR = makeGamma(1.0);
+
+/// @brief The ~2.2 sRGB-ish curve of PixelBuffer::enableGamma().
+inline constexpr GammaTable GAMMA_2_2 = makeGamma(2.2);
+
+} // namespace ws
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#if defined(WS2812_HOST) && WS2812_HOST
+typedef unsigned int uint; // as in pico/types.h
+#else
+#include "pico/types.h"
+#endif
+
+namespace ws {
+
+/**
+ * @brief Byte order on the wire, first byte sent first. W always goes last.
+ *
+ * WS2812(B) and SK6812 are GRB/GRBW; many clones are RGB or BRG.
+ */
+enum class ColorOrder : uint8_t { GRB, RGB, BRG, RBG, GBR, BGR };
+
+/**
+ * @brief Compile-time colour orders for BasicStrip.
+ *
+ * r/g/b are the byte positions (0 = sent first) of each channel.
+ */
+namespace order {
+struct GRB { static constexpr uint8_t r = 1, g = 0, b = 2; static constexpr ColorOrder id = ColorOrder::GRB; };
+struct RGB { static constexpr uint8_t r = 0, g = 1, b = 2; static constexpr ColorOrder id = ColorOrder::RGB; };
+struct BRG { static constexpr uint8_t r = 1, g = 2, b = 0; static constexpr ColorOrder id = ColorOrder::BRG; };
+struct RBG { static constexpr uint8_t r = 0, g = 2, b = 1; static constexpr ColorOrder id = ColorOrder::RBG; };
+struct GBR { static constexpr uint8_t r = 2, g = 0, b = 1; static constexpr ColorOrder id = ColorOrder::GBR; };
+struct BGR { static constexpr uint8_t r = 2, g = 1, b = 0; static constexpr ColorOrder id = ColorOrder::BGR; };
+} // namespace order
+
+namespace detail {
+
+// Pack n pixels of R,G,B[,W] source bytes (Stride 3 or 4) into wire data,
+// starting at pixel `first` of the staging buffer `out`. Order, W, wire
+// format and stride are all template parameters, so the loop has no
+// per-pixel branches and the shifts are immediates.
+// lut[0..3] are the R, G, B, W tables with gamma, white balance and
+// brightness folded in (often all the same one): one lookup per channel.
+// Returns the sum of all channel values sent, for the power estimate.
+template<class Order, bool W, bool Bytes, uint Stride>
+uint32_t pack_pixels(uint32_t* out, uint first, const uint8_t* p, uint n, const uint8_t* const* lut) {
+    constexpr uint C = W ? 4 : 3;
+    // First byte sent lands in bits 31..24: left-shift OSR, MSB first.
+    constexpr uint SR = 24 - 8 * Order::r, SG = 24 - 8 * Order::g, SB = 24 - 8 * Order::b;
+    uint8_t* o = reinterpret_cast<uint8_t*>(out) + (size_t)first * C;
+    out += first;
+    const uint8_t *lr = lut[0], *lg = lut[1], *lb = lut[2], *lw = lut[3];
+    uint32_t sum = 0;
+    for (uint i=0;i<n;++i, p+=Stride) {
+        uint32_t r = lr[p[0]], g = lg[p[1]], b = lb[p[2]];
+        uint32_t w = (W && Stride == 4) ? lw[p[3]] : 0;
+        sum += r + g + b + w;
+        if constexpr (Bytes) {
+            // Byte stream, sent MSB-first one byte per FIFO entry.
+            o[Order::r] = (uint8_t)r; o[Order::g] = (uint8_t)g; o[Order::b] = (uint8_t)b;
+            if (W) o[3] = (uint8_t)w;
+            o += C;
+        } else {
+            // RGBW words go out as is with autopull 32; RGB words with
+            // autopull 24 use bits 31..8 (W stays 0).
+            out[i] = (r<<SR) | (g<<SG) | (b<<SB) | w;
+        }
+    }
+    return sum;
+}
+
+// 16-bit variant with temporal dithering: each channel is looked up by
+// interpolating the 257-node 8.8 LUT, the residual of the previous frame is
+// added and the new residual kept, so fractional levels average out over
+// successive frames instead of being truncated.
+inline uint32_t dither_u16(uint16_t v, uint8_t& err, const uint16_t* lut) {
+    uint idx = v >> 8, f = v & 0xFF;
+    uint32_t lin = lut[idx] + (((uint32_t)(lut[idx+1] - lut[idx]) * f) >> 8);
+    uint32_t sum = lin + err;   // lin <= 255*256, so sum >> 8 <= 255
+    err = (uint8_t)sum;
+    return sum >> 8;
+}
+
+template<class Order, bool W, bool Bytes>
+uint32_t pack_pixels16(uint32_t* out, const uint16_t* p, uint n, const uint16_t* const* lut, uint8_t* err) {
+    constexpr uint C = W ? 4 : 3;
+    constexpr uint SR = 24 - 8 * Order::r, SG = 24 - 8 * Order::g, SB = 24 - 8 * Order::b;
+    uint8_t* o = reinterpret_cast<uint8_t*>(out);
+    uint32_t sum = 0;
+    for (uint i=0;i<n;++i, p+=C, err+=C) {
+        uint32_t r = dither_u16(p[0], err[0], lut[0]), g = dither_u16(p[1], err[1], lut[1]);
+        uint32_t b = dither_u16(p[2], err[2], lut[2]);
+        uint32_t w = W ? dither_u16(p[3], err[3], lut[3]) : 0;
+        sum += r + g + b + w;
+        if constexpr (Bytes) {
+            o[Order::r] = (uint8_t)r; o[Order::g] = (uint8_t)g; o[Order::b] = (uint8_t)b;
+            if (W) o[3] = (uint8_t)w;
+            o += C;
+        } else {
+            out[i] = (r<<SR) | (g<<SG) | (b<<SB) | w;
+        }
+    }
+    return sum;
+}
+
+using PackFn   = uint32_t (*)(uint32_t* out, uint first, const uint8_t* src, uint n, const uint8_t* const* lut);
+using PackFn16 = uint32_t (*)(uint32_t* out, const uint16_t* src, uint n, const uint16_t* const* lut, uint8_t* err);
+
+/// Packers for one colour order and pixel format, indexed by wire format and
+/// source stride. Chosen once per strip, so build_frame is one indirect call.
+struct PackKernels {
+    PackFn   words[2];    // [stride 3, stride 4]
+    PackFn   bytes[2];
+    PackFn16 words16, bytes16;
+};
+
+template<class Order, bool W>
+inline const PackKernels* pack_kernels() {
+    static constexpr PackKernels k = {
+        { &pack_pixels<Order, W, false, 3>, &pack_pixels<Order, W, false, 4> },
+        { &pack_pixels<Order, W, true,  3>, &pack_pixels<Order, W, true,  4> },
+        &pack_pixels16<Order, W, false>, &pack_pixels16<Order, W, true>,
+    };
+    return &k;
+}
+
+} // namespace detail
+} // namespace ws
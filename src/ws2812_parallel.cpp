@@ -0,0 +1,224 @@
+#include "ws2812_parallel.hpp"
+#include "ws2812_detail.hpp"
+#include "ws2812_resources.hpp"
+#include <algorithm>
+#include <cstring>
+
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "pico/stdlib.h"
+#include "ws2812.pio.h"
+
+#ifndef WS2812_USE_DMA
+#define WS2812_USE_DMA 1
+#endif
+
+namespace ws {
+
+static constexpr uint32_t RESET_US = 80;
+
+// One patched copy of ws2812_parallel per plane width (8, 16, 32).
+static constexpr uint PAR_LEN = sizeof(ws2812_parallel_program_instructions) / sizeof(uint16_t);
+static uint16_t      s_par_insn[3][PAR_LEN];
+static pio_program_t s_par_prog[3];
+static ParallelStrip* s_active = nullptr; // begun instances, linked through _next_active
+
+static const pio_program_t* parallel_program(uint width_idx) {
+    pio_program_t& p = s_par_prog[width_idx];
+    if (!p.instructions) {
+        std::memcpy(s_par_insn[width_idx], ws2812_parallel_program_instructions, sizeof(s_par_insn[0]));
+        s_par_insn[width_idx][0] = (uint16_t)pio_encode_out(pio_x, 8u << width_idx);
+        p = ws2812_parallel_program;
+        p.instructions = s_par_insn[width_idx];
+    }
+    return &p;
+}
+
+ParallelStrip::ParallelStrip(uint pin_base, uint lanes, uint count, bool rgbw,
+                             float freq, PIO pio, int sm)
+: _pin_base(pin_base), _lanes(lanes), _count(count), _rgbw(rgbw), _freq(freq),
+  _pio(pio), _sm(-1), _sm_req(sm), _dma_ch(-1), _width(8), _pio_offset(0),
+  _buf((size_t)lanes * count), _brightness(255), _gam(&GAMMA_LINEAR)
+{
+    detail::combined_lut(_lut, _gam->v8, _brightness);
+}
+
+bool ParallelStrip::begin() {
+    if (_lanes == 0 || _lanes > MAX_LANES) return false;
+    uint widx = _lanes <= 8 ? 0 : _lanes <= 16 ? 1 : 2;
+    _width = 8u << widx;
+
+    end(); // re-begin: drop what the previous begin() claimed
+
+    // One shared copy of the program for this plane width per PIO block
+    int offset = detail::program_acquire(_pio, parallel_program(widx));
+    if (offset < 0) return false;
+    _pio_offset = (uint)offset;
+    _prog_loaded = true;
+
+    _sm = detail::sm_claim(_pio, _sm_req);
+    if (_sm < 0) { end(); return false; }
+
+    ws2812_parallel_program_init(_pio, (uint)_sm, _pio_offset, _pin_base, _lanes, _freq);
+    _pixel_ns = (uint32_t)((_rgbw ? 32.0f : 24.0f) * 1e9f / _freq + 0.5f);
+
+#if WS2812_USE_DMA
+    _dma_ch = dma_claim_unused_channel(false);
+    if (_dma_ch >= 0) {
+        dma_channel_config c = dma_channel_get_default_config(_dma_ch);
+        channel_config_set_dreq(&c, pio_get_dreq(_pio, (uint)_sm, true));
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(_dma_ch, &c,
+                              (volatile void*)&_pio->txf[_sm], // write addr
+                              nullptr, 0, false);               // will set src/len on start
+    }
+#endif
+    // one N-bit plane per bit time: bits × N / 32 words per pixel index
+    _frame_tx.assign((size_t)_count * (_rgbw ? 32 : 24) * _width / 32, 0u);
+    _tx_in_flight = false;
+    clear();
+    _next_active = s_active;
+    s_active = this;
+    return true;
+}
+
+ParallelStrip::~ParallelStrip() { end(); }
+
+void ParallelStrip::end() {
+    for (ParallelStrip** p = &s_active; *p; p = &(*p)->_next_active)
+        if (*p == this) { *p = _next_active; _next_active = nullptr; break; }
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0) { dma_channel_abort(_dma_ch); dma_channel_unclaim(_dma_ch); _dma_ch = -1; }
+#endif
+    _tx_in_flight = false;
+    if (_sm >= 0) { pio_sm_set_enabled(_pio, (uint)_sm, false); pio_sm_unclaim(_pio, (uint)_sm); _sm = -1; }
+    if (_prog_loaded) { detail::program_release(_pio, _pio_offset); _prog_loaded = false; }
+}
+
+bool ParallelStrip::retime() {
+    if (_sm < 0) return false;
+    float div = ws2812_clkdiv(_freq, ws2812_parallel_CYCLES);
+    if (div < 1.0f) return false;
+    pio_sm_set_clkdiv(_pio, (uint)_sm, div);
+    return true;
+}
+
+bool ParallelStrip::retimeAll() {
+    bool ok = true;
+    for (ParallelStrip* s = s_active; s; s = s->_next_active) ok &= s->retime();
+    return ok;
+}
+
+void ParallelStrip::clear() { setAll(RGBW{0,0,0,0}); }
+
+void ParallelStrip::setAll(RGB c) { setAll(RGBW{c.r, c.g, c.b, 0}); }
+
+void ParallelStrip::setAll(RGBW c) { std::fill(_buf.begin(), _buf.end(), c); }
+
+void ParallelStrip::setPixel(uint lane, uint i, RGB c) { setPixel(lane, i, RGBW{c.r, c.g, c.b, 0}); }
+
+void ParallelStrip::setPixel(uint lane, uint i, uint8_t r, uint8_t g, uint8_t b) {
+    setPixel(lane, i, RGBW{r, g, b, 0});
+}
+
+void ParallelStrip::setPixel(uint lane, uint i, RGBW c) {
+    if (lane >= _lanes || i >= _count) return;
+    _buf[(size_t)lane * _count + i] = c;
+}
+
+void ParallelStrip::setBrightness(uint8_t b) {
+    if (b == _brightness) return;
+    _brightness = b;
+    detail::combined_lut(_lut, _gam->v8, _brightness);
+}
+
+void ParallelStrip::enableGamma(bool on) {
+    const GammaTable* g = on ? &GAMMA_2_2 : &GAMMA_LINEAR;
+    if (g == _gam) return;
+    _gam = g;
+    detail::combined_lut(_lut, _gam->v8, _brightness);
+}
+
+// 8x8 bit transpose (Hacker's Delight 7-3): o[k*step] bit l = a[l] bit (7-k),
+// i.e. plane k holds the k-th most significant bit of every lane, lane 0 in bit 0.
+static inline void transpose8(const uint8_t a[8], uint8_t* o, uint step) {
+    uint32_t x = (uint32_t(a[7])<<24) | (uint32_t(a[6])<<16) | (uint32_t(a[5])<<8) | a[4];
+    uint32_t y = (uint32_t(a[3])<<24) | (uint32_t(a[2])<<16) | (uint32_t(a[1])<<8) | a[0];
+    uint32_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+    o[0*step] = (uint8_t)(x>>24); o[1*step] = (uint8_t)(x>>16); o[2*step] = (uint8_t)(x>>8); o[3*step] = (uint8_t)x;
+    o[4*step] = (uint8_t)(y>>24); o[5*step] = (uint8_t)(y>>16); o[6*step] = (uint8_t)(y>>8); o[7*step] = (uint8_t)y;
+}
+
+void ParallelStrip::build_frame() {
+    // The SM shifts right, so on this little-endian core the word stream is a
+    // byte stream of planes: per pixel, per bit (MSB first), per group of 8 lanes.
+    const uint groups = _width / 8;
+    const uint chans = _rgbw ? 4 : 3;
+    uint8_t* o = reinterpret_cast<uint8_t*>(_frame_tx.data());
+    for (uint i=0;i<_count;++i) {
+        for (uint g=0;g<groups;++g) {
+            uint8_t c[4][8] = {};   // G, R, B, W of the group's 8 lanes
+            for (uint l=0;l<8;++l) {
+                uint lane = g*8 + l;
+                if (lane >= _lanes) break;
+                RGBW p = _buf[(size_t)lane * _count + i];
+                c[0][l] = _lut[p.g];
+                c[1][l] = _lut[p.r];
+                c[2][l] = _lut[p.b];
+                c[3][l] = _lut[p.w];
+            }
+            for (uint ch=0;ch<chans;++ch) transpose8(c[ch], o + ch*8*groups + g, groups);
+        }
+        o += chans * 8 * groups;
+    }
+}
+
+bool ParallelStrip::busy() const {
+    if (!_tx_in_flight) return false;
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0 && dma_channel_is_busy(_dma_ch)) return true;
+#endif
+    return !time_reached(_latch_until);
+}
+
+void ParallelStrip::wait() {
+    if (!_tx_in_flight) return;
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0) while (dma_channel_is_busy(_dma_ch)) { tight_loop_contents(); }
+#endif
+    sleep_until(_latch_until);
+    _tx_in_flight = false;
+}
+
+void ParallelStrip::showAsync() {
+    if (_frame_tx.empty()) return; // begin() not called
+    wait();
+    build_frame();
+    uint64_t frame_us = ((uint64_t)_count * _pixel_ns + 999) / 1000;
+    _latch_until = delayed_by_us(get_absolute_time(), frame_us + 1 + RESET_US);
+    _tx_in_flight = true;
+#if WS2812_USE_DMA
+    if (_dma_ch >= 0) {
+        dma_channel_set_read_addr(_dma_ch, _frame_tx.data(), false);
+        dma_channel_set_trans_count(_dma_ch, (uint)_frame_tx.size(), true);
+        return;
+    }
+#endif
+    for (uint32_t w : _frame_tx) pio_sm_put_blocking(_pio, (uint)_sm, w);
+}
+
+void ParallelStrip::show() {
+    showAsync();
+    wait();
+}
+
+} // namespace ws
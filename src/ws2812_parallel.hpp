@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "hardware/pio.h"
+#include "pico/time.h"
+#include "ws2812.hpp"
+
+namespace ws {
+
+/**
+ * @brief Drives up to 32 strips on consecutive GPIOs from a single PIO state machine.
+ *
+ * Key points:
+ * - Uses the ws2812_parallel program: every FIFO word carries bit-planes of all
+ *   lanes (bit l = lane l), so one SM and one DMA channel feed every strip.
+ * - The packer transposes per-lane pixel data into those bit-planes.
+ * - Lanes are padded to a plane width of 8, 16 or 32; unused lanes cost only
+ *   staging RAM (count × 3/4 bytes per padded lane), no pins.
+ * - All lanes share length, pixel format, brightness and gamma.
+ *
+ * Threading:
+ * - Not re-entrant. Don’t call from multiple contexts simultaneously.
+ */
+class ParallelStrip {
+public:
+    static constexpr uint MAX_LANES = 32;
+
+    /**
+     * @brief Construct a parallel driver (no hardware setup yet).
+     * @param pin_base First GPIO; lane l is on pin_base + l.
+     * @param lanes    Number of strips (1..32).
+     * @param count    LEDs per strip (valid indices: 0..count-1).
+     * @param rgbw     true for SK6812 (GRBW), false for WS2812(B) (GRB).
+     * @param freq     Data rate in Hz (default 800 kHz).
+     * @param pio      PIO block (pio0/pio1, pio2 on RP2350).
+     * @param sm       State machine index; -1 to auto-claim a free one.
+     */
+    ParallelStrip(uint pin_base, uint lanes, uint count, bool rgbw=false,
+                  float freq=800000.0f, PIO pio=pio0, int sm=-1);
+
+    /// @brief Calls end().
+    ~ParallelStrip();
+
+    /**
+     * @brief Initialize PIO (and DMA if enabled).
+     * @return false if lanes is out of range, no SM is available or the
+     *         program can't be loaded. Programs are shared per PIO block as
+     *         for Strip, and a failed begin() releases what it claimed.
+     */
+    bool begin();
+
+    /// @brief Release SM/DMA and the program reference. Call begin() again to re-initialize.
+    void end();
+
+    /// @brief true if begin() got a DMA channel; false means blocking sends.
+    inline bool hasDma() const { return _dma_ch >= 0; }
+
+    /// @brief Recompute the clock divider after a clk_sys change (see Strip::retime()).
+    bool retime();
+
+    /// @brief retime() every begun ParallelStrip. @return false if any failed.
+    static bool retimeAll();
+
+    /// @brief Number of lanes (strips).
+    inline uint lanes() const { return _lanes; }
+
+    /// @brief LEDs per lane.
+    inline uint size() const { return _count; }
+
+    /// @brief Set every pixel of every lane to off. Does not send.
+    void clear();
+
+    /// @brief Set all pixels of all lanes.
+    void setAll(RGB c);
+    void setAll(RGBW c);
+
+    /// @brief Set one pixel of one lane. Out-of-range lane/index is ignored.
+    void setPixel(uint lane, uint i, RGB c);
+    void setPixel(uint lane, uint i, uint8_t r, uint8_t g, uint8_t b);
+    void setPixel(uint lane, uint i, RGBW c);
+
+    /// @brief Global brightness [0..255]. Applied when sending.
+    void setBrightness(uint8_t b);
+
+    /// @brief Enable/disable ~2.2 gamma correction.
+    void enableGamma(bool on);
+
+    /// @brief Send all lanes (blocking), including the reset latch.
+    void show();
+
+    /// @brief Pack and start sending all lanes; returns once DMA is armed.
+    void showAsync();
+
+    /// @brief true while a frame is in flight or latching.
+    bool busy() const;
+
+    /// @brief Block until the frame finished and the reset latch elapsed.
+    void wait();
+
+private:
+    /// Transpose _buf into bit-plane words in _frame_tx.
+    void build_frame();
+
+    uint            _pin_base, _lanes, _count;
+    bool            _rgbw;
+    float           _freq;
+    PIO             _pio;
+    int             _sm;            // claimed SM, -1 if none
+    int             _sm_req;        // SM asked for in the constructor, -1 = any
+    int             _dma_ch;        // -1 if none
+    uint            _width;         // plane width N (8/16/32)
+    uint            _pio_offset;
+    bool            _prog_loaded = false; // holding a program reference
+    ParallelStrip*  _next_active = nullptr; // begun instances, for retimeAll()
+
+    std::vector<RGBW>     _buf;       // lane-major: _buf[lane*count + i]
+    std::vector<uint32_t> _frame_tx;  // bit-plane words
+    uint8_t         _brightness;
+    const GammaTable* _gam;           // shared table in flash
+    uint8_t         _lut[256];        // gamma x brightness
+    bool            _tx_in_flight = false;
+    uint32_t        _pixel_ns = 30000;     // wire time of one pixel index
+    absolute_time_t _latch_until = {};
+
+    ParallelStrip(const ParallelStrip&) = delete;
+    ParallelStrip& operator=(const ParallelStrip&) = delete;
+};
+
+} // namespace ws
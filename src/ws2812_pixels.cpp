@@ -0,0 +1,331 @@
+#include "ws2812_pixels.hpp"
+#include "ws2812_detail.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace ws {
+
+// Runtime colour order -> packers; this table is what links all orders in.
+template<bool W>
+static const detail::PackKernels* kernels_for(ColorOrder o) {
+    switch (o) {
+    case ColorOrder::RGB: return detail::pack_kernels<order::RGB, W>();
+    case ColorOrder::BRG: return detail::pack_kernels<order::BRG, W>();
+    case ColorOrder::RBG: return detail::pack_kernels<order::RBG, W>();
+    case ColorOrder::GBR: return detail::pack_kernels<order::GBR, W>();
+    case ColorOrder::BGR: return detail::pack_kernels<order::BGR, W>();
+    default:              return detail::pack_kernels<order::GRB, W>();
+    }
+}
+
+PixelBuffer::PixelBuffer(uint count, bool rgbw, ColorOrder order)
+: PixelBuffer(count, rgbw, rgbw ? kernels_for<true>(order) : kernels_for<false>(order))
+{
+}
+
+PixelBuffer::PixelBuffer(uint count, bool rgbw, const detail::PackKernels* kern)
+: _count(count), _npx(count), _rgbw(rgbw), _bpp(rgbw ? 4 : 3), _buf((size_t)count * _bpp), _kern(kern)
+{
+    // default gamma is identity until enabled
+    for (auto& g : _gam) g = &GAMMA_LINEAR;
+    rebuild_lut();
+}
+
+void PixelBuffer::set_depth16(bool on) {
+    // 8-bit, or 16-bit plus per-channel dither residuals
+    _depth16 = on;
+    _npx = _count;
+    const size_t chans = (size_t)_count * _bpp;
+    if (_depth16) {
+        std::vector<uint8_t>().swap(_buf);
+        _buf16.assign(chans, 0);
+        _dither_err.assign(chans, 0);
+    } else {
+        _buf.resize(chans);
+        for (auto* v : {&_buf16, &_lut16}) std::vector<uint16_t>().swap(*v);
+        std::vector<uint8_t>().swap(_dither_err);
+    }
+    rebuild_lut(); // also marks everything dirty
+}
+
+void PixelBuffer::release_pixels() {
+    set_depth16(false);
+    std::vector<uint8_t>().swap(_buf);
+    _npx = 0;
+}
+
+void PixelBuffer::mark_dirty(uint lo, uint hi) {
+    for (int k=0;k<2;++k) {
+        if (lo < _dirty_lo[k]) _dirty_lo[k] = lo;
+        if (hi > _dirty_hi[k]) _dirty_hi[k] = hi;
+    }
+}
+
+void PixelBuffer::clear() {
+    if (_depth16) std::fill(_buf16.begin(), _buf16.end(), 0);
+    else          std::memset(_buf.data(), 0, _buf.size());
+    mark_dirty(0, _count);
+}
+
+void PixelBuffer::setAll(RGB c) { setAll(RGBW{c.r, c.g, c.b, 0}); }
+
+void PixelBuffer::setAll(RGBW c) {
+    if (_depth16) { setAll(RGBW16{uint16_t(c.r*257u), uint16_t(c.g*257u), uint16_t(c.b*257u), uint16_t(c.w*257u)}); return; }
+    uint8_t* p = _buf.data();
+    if (_rgbw) for (uint i=0;i<_npx;++i, p+=4) { p[0]=c.r; p[1]=c.g; p[2]=c.b; p[3]=c.w; }
+    else       for (uint i=0;i<_npx;++i, p+=3) { p[0]=c.r; p[1]=c.g; p[2]=c.b; }
+    mark_dirty(0, _count);
+}
+
+void PixelBuffer::setPixel(uint i, RGB c) { setPixel(i, RGBW{c.r, c.g, c.b, 0}); }
+
+void PixelBuffer::setPixel(uint i, uint8_t r, uint8_t g, uint8_t b) { setPixel(i, RGBW{r, g, b, 0}); }
+
+void PixelBuffer::setAll(RGBW16 c) {
+    if (!_depth16) { setAll(RGBW{uint8_t(c.r>>8), uint8_t(c.g>>8), uint8_t(c.b>>8), uint8_t(c.w>>8)}); return; }
+    uint16_t* p = _buf16.data();
+    if (_rgbw) for (uint i=0;i<_npx;++i, p+=4) { p[0]=c.r; p[1]=c.g; p[2]=c.b; p[3]=c.w; }
+    else       for (uint i=0;i<_npx;++i, p+=3) { p[0]=c.r; p[1]=c.g; p[2]=c.b; }
+    mark_dirty(0, _count);
+}
+
+void PixelBuffer::setPixel(uint i, RGBW16 c) {
+    if (i >= _npx) return;
+    if (!_depth16) { setPixel(i, RGBW{uint8_t(c.r>>8), uint8_t(c.g>>8), uint8_t(c.b>>8), uint8_t(c.w>>8)}); return; }
+    uint16_t* p = &_buf16[(size_t)i * _bpp];
+    p[0] = c.r; p[1] = c.g; p[2] = c.b;
+    if (_rgbw) p[3] = c.w;
+    mark_dirty(i, i + 1);
+}
+
+void PixelBuffer::setPixel(uint i, RGBW c) {
+    if (i >= _npx) return;
+    if (_depth16) { setPixel(i, RGBW16{uint16_t(c.r*257u), uint16_t(c.g*257u), uint16_t(c.b*257u), uint16_t(c.w*257u)}); return; }
+    uint8_t* p = &_buf[(size_t)i * _bpp];
+    p[0] = c.r; p[1] = c.g; p[2] = c.b;
+    if (_rgbw) p[3] = c.w;
+    mark_dirty(i, i + 1);
+}
+
+void PixelBuffer::rebuild_lut() {
+    // Each channel's full level: white balance x colour temperature.
+    const uint8_t wb[4] = { detail::scale_u8(_balance.r, _temp.r), detail::scale_u8(_balance.g, _temp.g),
+                            detail::scale_u8(_balance.b, _temp.b), _balance.w };
+    const uint chans = _rgbw ? 4 : 3;
+    // Channels that agree share one table, so the usual case stays 256 bytes.
+    bool same = true;
+    for (uint c=1;c<chans;++c) same = same && _gam[c] == _gam[0] && wb[c] == wb[0];
+    const uint tables = same ? 1 : chans;
+    _lut.resize((size_t)tables * 256);
+    for (uint c=0;c<tables;++c) detail::combined_lut(&_lut[c * 256], _gam[c]->v8, _lut_b, wb[c]);
+    for (uint c=0;c<4;++c) _lut_ch[c] = &_lut[(c < tables ? c : 0) * 256];
+    if (_depth16) {
+        _lut16.resize((size_t)tables * 257);
+        for (uint c=0;c<tables;++c) detail::combined_lut16(&_lut16[c * 257], _gam[c]->v16, _lut_b, wb[c]);
+        for (uint c=0;c<4;++c) _lut16_ch[c] = &_lut16[(c < tables ? c : 0) * 257];
+    }
+    mark_dirty(0, _count);
+}
+
+void PixelBuffer::reserve_luts() {
+    const uint chans = _rgbw ? 4 : 3;
+    _lut.reserve((size_t)chans * 256);
+    if (_depth16) _lut16.reserve((size_t)chans * 257);
+    rebuild_lut(); // channel pointers into the reserved storage
+}
+
+void PixelBuffer::setBrightness(uint8_t b) {
+    if (b == _brightness) return;
+    _brightness = b;
+    // Limited: never jump above the current cap, the next frame raises it.
+    uint8_t lb = _power_budget ? std::min(b, _lut_b) : b;
+    if (lb != _lut_b) { _lut_b = lb; rebuild_lut(); }
+    else if (_power_budget) mark_dirty(0, _count); // re-evaluate on the next frame
+}
+
+void PixelBuffer::setPowerLimit(uint32_t budget_ma, uint16_t ma_per_channel, uint16_t idle_ma) {
+    _power_budget = budget_ma;
+    _ma_per_ch = ma_per_channel;
+    _idle_ma = idle_ma;
+    if (!budget_ma && _lut_b != _brightness) { _lut_b = _brightness; rebuild_lut(); }
+    mark_dirty(0, _count); // next frame measures the whole strip
+}
+
+void PixelBuffer::limit_power(uint32_t sum) {
+    // sum is at brightness _lut_b, and brightness scales linearly after gamma.
+    const uint64_t load = (uint64_t)sum * _ma_per_ch / 255;
+    const uint32_t idle = _count * _idle_ma;
+    _est_ma = (uint32_t)std::min<uint64_t>(load + idle, UINT32_MAX);
+    if (!_power_budget) return;
+    const uint64_t avail = _power_budget > idle ? _power_budget - idle : 0;
+    uint32_t b = _lut_b;
+    if (load > avail) {
+        b = (uint32_t)(b * avail / load);
+    } else if (b < _brightness) {
+        // Raise by at least two steps (or to the cap) so LUT rounding at the
+        // budget edge doesn't toggle the level, and repack, every frame.
+        uint32_t up = load ? (uint32_t)std::min<uint64_t>(_brightness, b * avail / load) : _brightness;
+        if (up >= b + 2 || up == _brightness) b = up;
+    }
+    b = std::max<uint32_t>(b, _brightness ? 1 : 0); // at 0 nothing would be measured again
+    if (b != _lut_b) { _lut_b = (uint8_t)b; rebuild_lut(); }
+}
+
+void PixelBuffer::enableGamma(bool on) {
+    setGamma(on ? GAMMA_2_2 : GAMMA_LINEAR);
+}
+
+void PixelBuffer::setGamma(const GammaTable& all) {
+    setGamma(all, all, all, all);
+}
+
+void PixelBuffer::setGamma(const GammaTable& r, const GammaTable& g, const GammaTable& b, const GammaTable& w) {
+    if (_gam[0] == &r && _gam[1] == &g && _gam[2] == &b && _gam[3] == &w) return;
+    _gam[0] = &r; _gam[1] = &g; _gam[2] = &b; _gam[3] = &w;
+    rebuild_lut();
+}
+
+void PixelBuffer::setWhiteBalance(RGBW scale) {
+    _balance = scale;
+    rebuild_lut();
+}
+
+// Black-body colour, 1000..12000 K in 200 K steps (Tanner Helland's fit of
+// Mitchell Charity's table), so 6600 K is exactly neutral.
+static const RGB s_kelvin[56] = {
+    {255,  68,   0}, {255,  86,   0}, {255, 101,   0}, {255, 115,   0},
+    {255, 126,   0}, {255, 137,  14}, {255, 146,  39}, {255, 155,  61},
+    {255, 163,  79}, {255, 170,  95}, {255, 177, 110}, {255, 184, 123},
+    {255, 190, 135}, {255, 195, 146}, {255, 201, 157}, {255, 206, 166},
+    {255, 211, 175}, {255, 215, 183}, {255, 220, 191}, {255, 224, 199},
+    {255, 228, 206}, {255, 232, 213}, {255, 236, 219}, {255, 239, 225},
+    {255, 243, 231}, {255, 246, 237}, {255, 249, 242}, {255, 253, 248},
+    {255, 255, 255}, {250, 246, 255}, {243, 242, 255}, {237, 239, 255},
+    {232, 236, 255}, {228, 234, 255}, {224, 232, 255}, {221, 230, 255},
+    {218, 228, 255}, {216, 227, 255}, {214, 225, 255}, {212, 224, 255},
+    {210, 223, 255}, {208, 222, 255}, {206, 221, 255}, {205, 220, 255},
+    {203, 219, 255}, {202, 218, 255}, {200, 217, 255}, {199, 217, 255},
+    {198, 216, 255}, {197, 215, 255}, {196, 214, 255}, {195, 214, 255},
+    {194, 213, 255}, {193, 213, 255}, {192, 212, 255}, {191, 211, 255},
+};
+
+void PixelBuffer::setColorTemperature(uint kelvin) {
+    kelvin = std::min(std::max(kelvin, 1000u), 12000u) - 1000u;
+    const uint i = std::min(kelvin / 200u, 54u), f = kelvin - i * 200u; // f in 0..200
+    const RGB& a = s_kelvin[i];
+    const RGB& b = s_kelvin[i + 1];
+    auto mix = [f](uint x, uint y) { return (uint8_t)((x * (200u - f) + y * f + 100u) / 200u); };
+    _temp = RGB{mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b)};
+    rebuild_lut();
+}
+
+static_assert(sizeof(RGB) == 3 && sizeof(RGBW) == 4, "pixel structs are packed as raw R,G,B[,W] bytes");
+
+uint32_t PixelBuffer::build_frame16(uint32_t* out, uint first, uint n) {
+    const size_t c = (size_t)first * _bpp;
+    return (_byte_wire ? _kern->bytes16 : _kern->words16)(out, &_buf16[c], n,
+                                                          _lut16_ch, &_dither_err[c]);
+}
+
+uint32_t PixelBuffer::build_frame(uint32_t* out, uint first, const uint8_t* src, uint stride, uint n) {
+    return (_byte_wire ? _kern->bytes : _kern->words)[stride == 4](out, first, src, n, _lut_ch);
+}
+
+void PixelBuffer::pack_dirty(uint32_t* out, uint k) {
+    if (!_npx) return;
+    // Only the pixels touched since this buffer was last packed.
+    uint lo = _dirty_lo[k], hi = _dirty_hi[k];
+    _dirty_lo[k] = _count; _dirty_hi[k] = 0;
+    if (_depth16) {
+        // Dithering changes every frame: always a full pass, ideally while
+        // the other staging buffer is on the wire (double_buffer).
+        limit_power(build_frame16(out, 0, _count));
+    } else if (lo < hi) {
+        // The power estimate needs the whole frame's sum.
+        if (_power_budget) { lo = 0; hi = _count; }
+        uint32_t sum = build_frame(out, lo, &_buf[(size_t)lo * _bpp], _bpp, hi - lo);
+        if (_power_budget || (lo == 0 && hi == _count)) limit_power(sum);
+    }
+}
+
+void PixelBuffer::pack_from(uint32_t* out, uint k, const uint8_t* src, uint stride, uint n) {
+    limit_power(build_frame(out, 0, src, stride, n));
+    // The staging buffer no longer mirrors _buf.
+    _dirty_lo[k] = 0; _dirty_hi[k] = _count;
+}
+
+void PixelBuffer::pack(const RGB* src, size_t n, uint32_t* out) const {
+    _kern->words[0](out, 0, reinterpret_cast<const uint8_t*>(src), (uint)n, _lut_ch);
+}
+
+void PixelBuffer::pack(const RGBW* src, size_t n, uint32_t* out) const {
+    _kern->words[1](out, 0, reinterpret_cast<const uint8_t*>(src), (uint)n, _lut_ch);
+}
+
+// round(a*b/255) without a divide, exact for a, b <= 255.
+static inline uint mul_div255(uint a, uint b) {
+    uint y = a * b + 128;
+    return (y + (y >> 8)) >> 8;
+}
+
+ws::RGB PixelBuffer::hsv16(uint16_t h, uint8_t s, uint8_t v) {
+    uint32_t h6 = (uint32_t)h * 6u;
+    uint sector = h6 >> 16;          // 0..5
+    uint f = (h6 >> 8) & 0xFF;       // position within the sector
+    uint8_t p = (uint8_t)mul_div255(v, 255u - s);
+    uint8_t q = (uint8_t)mul_div255(v, 255u - mul_div255(s, f));        // falling edge
+    uint8_t t = (uint8_t)mul_div255(v, 255u - mul_div255(s, 255u - f)); // rising edge
+    switch (sector) {
+        case 0:  return RGB{v, t, p};
+        case 1:  return RGB{q, v, p};
+        case 2:  return RGB{p, v, t};
+        case 3:  return RGB{p, q, v};
+        case 4:  return RGB{t, p, v};
+        default: return RGB{v, p, q};
+    }
+}
+
+void PixelBuffer::rainbow(RGB* out, size_t n, uint16_t hue, int16_t step, uint8_t sat, uint8_t val) {
+    for (size_t i=0;i<n;++i, hue = (uint16_t)(hue + step)) out[i] = hsv16(hue, sat, val);
+}
+
+void PixelBuffer::fillRainbow(uint first, uint n, uint16_t hue, int16_t step, uint8_t sat, uint8_t val) {
+    if (first >= _npx) return;
+    n = std::min(n, _npx - first);
+    if (_depth16) {
+        for (uint i=0;i<n;++i, hue = (uint16_t)(hue + step)) setPixel(first + i, hsv16(hue, sat, val));
+        return;
+    }
+    uint8_t* p = &_buf[(size_t)first * _bpp];
+    for (uint i=0;i<n;++i, p+=_bpp, hue = (uint16_t)(hue + step)) {
+        RGB c = hsv16(hue, sat, val);
+        p[0] = c.r; p[1] = c.g; p[2] = c.b;
+        if (_rgbw) p[3] = 0;
+    }
+    mark_dirty(first, first + n);
+}
+
+ws::RGB PixelBuffer::hsv(float h, float s, float v) {
+    h = fmodf(h, 360.0f); if (h < 0) h += 360.0f;
+    s = std::clamp(s, 0.0f, 1.0f);
+    v = std::clamp(v, 0.0f, 1.0f);
+    float c = v * s;
+    float x = c * (1.0f - fabsf(fmodf(h/60.0f, 2.0f) - 1.0f));
+    float m = v - c;
+    float r=0,g=0,b=0;
+    int seg = (int)(h/60.0f);
+    switch(seg) {
+        case 0: r=c; g=x; b=0; break;
+        case 1: r=x; g=c; b=0; break;
+        case 2: r=0; g=c; b=x; break;
+        case 3: r=0; g=x; b=c; break;
+        case 4: r=x; g=0; b=c; break;
+        default:r=c; g=0; b=x; break;
+    }
+    return RGB{ (uint8_t)std::round((r+m)*255.0f),
+                (uint8_t)std::round((g+m)*255.0f),
+                (uint8_t)std::round((b+m)*255.0f) };
+}
+
+} // namespace ws
@@ -0,0 +1,280 @@
+#pragma once
+// SDK-free pixel pipeline: pixel buffer, gamma/brightness, power estimate and
+// packing into wire words. The transport (PIO/DMA in Strip, capture on a
+// host build) only ever sees the packed words.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ws2812_gamma.hpp"
+#include "ws2812_pack.hpp"
+
+namespace ws {
+
+/**
+ * @brief 8-bit RGB color (0..255 per channel).
+ */
+struct RGB { uint8_t r, g, b; };
+
+/**
+ * @brief 8-bit RGBW color (0..255 per channel). W is ignored on plain WS2812.
+ */
+struct RGBW { uint8_t r, g, b, w; };
+
+/**
+ * @brief 16-bit RGBW color (0..65535 per channel) for Options::depth16 strips.
+ */
+struct RGBW16 { uint16_t r, g, b, w; };
+
+/**
+ * @brief Chunked frame source (Strip::showChunked()): fill LEDs first..first+n-1
+ * as RGBW into out. W is ignored on RGB strips.
+ */
+using PixelSourceFn = void (*)(void* ctx, uint first, uint n, RGBW* out);
+
+/**
+ * @brief Pixel buffer and packer shared by every transport.
+ *
+ * Holds the logical pixels (8 or 16 bits per channel), the combined gamma x
+ * brightness table and the packers for one colour order and format, and
+ * tracks which pixels changed since each staging buffer was packed. Contains
+ * nothing hardware specific: Strip adds PIO/DMA, CaptureStrip (host builds,
+ * ws2812_capture.hpp) records the packed frames.
+ */
+class PixelBuffer {
+public:
+    /// @brief Number of LEDs.
+    inline uint size() const { return _count; }
+
+    /// @brief true for 4-channel (SK6812 RGBW) strips.
+    inline bool isRgbw() const { return _rgbw; }
+
+    /// @brief false if the transport runs without a pixel buffer (Strip::Options::pixel_buffer).
+    inline bool hasPixels() const { return _npx != 0; }
+
+    /**
+     * @brief Set the entire internal buffer to off (black). Does not send.
+     * @see Strip::show()
+     */
+    void clear();
+
+    /**
+     * @brief Set all pixels (RGB) in the buffer.
+     * @param c Color (R,G,B). W remains 0 on RGBW strips.
+     */
+    void setAll(RGB c);
+
+    /**
+     * @brief Set all pixels (RGBW) in the buffer.
+     * @param c Color (R,G,B,W). W is ignored on WS2812.
+     */
+    void setAll(RGBW c);
+
+    /**
+     * @brief Set one pixel (RGB) in the buffer. Out-of-range indices are ignored.
+     * @param i Pixel index [0..size()-1].
+     * @param c Color.
+     */
+    void setPixel(uint i, RGB c);
+
+    /// @brief Set one pixel (RGB) in the buffer.
+    void setPixel(uint i, uint8_t r, uint8_t g, uint8_t b);
+
+    /// @brief Set one pixel (RGBW) in the buffer.
+    void setPixel(uint i, RGBW c);
+
+    /**
+     * @brief Set one pixel at 16 bits per channel. W is ignored on WS2812.
+     *
+     * Full precision with Strip::Options::depth16; otherwise truncated to 8 bits.
+     * (8-bit setters on a depth16 strip scale by 257.)
+     */
+    void setPixel(uint i, RGBW16 c);
+
+    /// @brief Set all pixels at 16 bits per channel.
+    void setAll(RGBW16 c);
+
+    /**
+     * @brief Global brightness [0..255]. Applied when packing.
+     *
+     * Folded together with gamma and white balance into the packing table
+     * (one table, or one per channel once the channels differ), rebuilt only
+     * when one of them changes, so packing is one lookup per channel.
+     */
+    void setBrightness(uint8_t b);
+
+    /**
+     * @brief Enable/disable ~2.2 gamma correction (sRGB-ish) on every channel.
+     *
+     * Selects the shared GAMMA_2_2 or GAMMA_LINEAR table (in flash) and
+     * rebuilds the packing table; no curve is computed at run time.
+     */
+    void enableGamma(bool on);
+
+    /**
+     * @brief Gamma curve for every channel, or one per channel (W ignored on RGB strips).
+     *
+     * Tables come from makeGamma(), as `static constexpr` objects: they are
+     * referenced, not copied, and must outlive the strip. E.g. a steeper blue
+     * curve for LEDs whose blue looks too bright at low levels.
+     */
+    void setGamma(const GammaTable& all);
+    void setGamma(const GammaTable& r, const GammaTable& g, const GammaTable& b, const GammaTable& w);
+
+    /**
+     * @brief White balance: each channel's full level, 255 = unchanged.
+     *
+     * Folded into the packing table after gamma, so it costs nothing per
+     * pixel. Matches batches of LEDs or corrects an LED type's tint, e.g.
+     * {255, 176, 240, 255} for the bluish green of typical 5050 strips.
+     */
+    void setWhiteBalance(RGBW scale);
+
+    /**
+     * @brief Tint R, G, B towards the colour of a black body at `kelvin`.
+     *
+     * 1000..12000 K, clamped; 6600 is neutral (the default), 2700 gives
+     * incandescent-warm whites, higher values bluish daylight. Multiplies
+     * with setWhiteBalance(); W is left alone, it has its own white point.
+     */
+    void setColorTemperature(uint kelvin);
+
+    /**
+     * @brief Keep the estimated supply current within a budget by scaling brightness.
+     * @param budget_ma      Budget for this strip in mA; 0 turns the limiter off.
+     * @param ma_per_channel Current of one channel at full level (~20 mA on WS2812B/SK6812).
+     * @param idle_ma        Quiescent current per LED, taken off the budget first.
+     *
+     * The estimate is the sum of all channel values, after gamma and
+     * brightness, accumulated by the packer itself, so no extra pass over
+     * memory. It is evaluated after each frame is packed and scales the
+     * brightness actually applied (never above setBrightness()) for the next
+     * frame, i.e. a frame that suddenly brightens may exceed the budget once.
+     * While on, any change repacks the whole strip to keep the sum exact.
+     * Raw/pre-packed word paths are not estimated.
+     */
+    void setPowerLimit(uint32_t budget_ma, uint16_t ma_per_channel = 20, uint16_t idle_ma = 1);
+
+    /// @brief Estimated current of the last packed frame in mA (see setPowerLimit()).
+    /// With the limiter off, only frames packed in full update it.
+    inline uint32_t estimatedCurrent() const { return _est_ma; }
+
+    /// @brief Brightness in effect after power limiting (setBrightness() value if off).
+    inline uint8_t appliedBrightness() const { return _lut_b; }
+
+    /**
+     * @brief Pack pixels into wire words with the current brightness/gamma.
+     *
+     * For building segments for Strip::showSegments() or Strip::showFrom(const
+     * uint32_t*). Always writes 32-bit words, whatever the wire format.
+     */
+    void pack(const RGB* src, size_t n, uint32_t* out) const;
+    void pack(const RGBW* src, size_t n, uint32_t* out) const;
+
+    /**
+     * @brief Utility: HSV → RGB (H: 0..360, S/V: 0..1).
+     *
+     * Float math is soft-float on the RP2040; prefer hsv16() in per-pixel loops.
+     */
+    static RGB hsv(float h, float s, float v);
+
+    /**
+     * @brief Integer HSV → RGB. H: 0..65535 for the full circle, S/V: 0..255.
+     *
+     * No floats and no divides: a few multiplies and shifts.
+     */
+    static RGB hsv16(uint16_t h, uint8_t s, uint8_t v);
+
+    /**
+     * @brief Fill n caller pixels with a hue gradient: out[i] = hsv16(hue + i*step, sat, val).
+     */
+    static void rainbow(RGB* out, size_t n, uint16_t hue, int16_t step,
+                        uint8_t sat = 255, uint8_t val = 255);
+
+    /**
+     * @brief Fill pixels first..first+n-1 with a hue gradient (see rainbow()).
+     *
+     * One bounds check and one dirty-range update for the whole run. W is set to 0.
+     */
+    void fillRainbow(uint first, uint n, uint16_t hue, int16_t step,
+                     uint8_t sat = 255, uint8_t val = 255);
+
+protected:
+    /// Runtime colour order: links the packers for every order.
+    PixelBuffer(uint count, bool rgbw, ColorOrder order);
+    /// Packers fixed at compile time (BasicStrip).
+    PixelBuffer(uint count, bool rgbw, const detail::PackKernels* kern);
+
+    /// Anything to pack into staging buffer k (0/1)? Always with depth16.
+    inline bool needs_pack(uint k) const { return _depth16 || _dirty_lo[k] < _dirty_hi[k]; }
+
+    /// Repack what changed in _buf since staging buffer k was last packed
+    /// (everything with depth16 or the power limiter) and mark it clean.
+    void pack_dirty(uint32_t* out, uint k);
+
+    /// Pack n caller pixels into staging buffer k, which then no longer mirrors _buf.
+    void pack_from(uint32_t* out, uint k, const uint8_t* src, uint stride, uint n);
+
+    /// Switch between 8-bit and 16-bit (dithered) pixel storage; clear() afterwards.
+    void set_depth16(bool on);
+
+    /// Free the pixel buffer: setters and Segment views then do nothing, the
+    /// transport gets its pixels elsewhere. set_depth16() brings it back.
+    void release_pixels();
+
+    /// Pack n R,G,B[,W] pixels (stride 3/4 bytes) into wire-order words, or
+    /// bytes with byte_wire, at pixels first..first+n-1 of staging buffer out.
+    /// Returns the sum of the channel values packed.
+    uint32_t build_frame(uint32_t* out, uint first, const uint8_t* src, uint stride, uint n);
+
+    /// Pack pixels first..first+n-1 of the 16-bit buffer, with temporal
+    /// dithering (Options::depth16), to the start of out.
+    uint32_t build_frame16(uint32_t* out, uint first, uint n);
+
+    /// Rebuild _lut (and _lut16) for gamma, white balance and brightness _lut_b.
+    void rebuild_lut();
+
+    /// Give _lut (and _lut16) room for a table per channel, so rebuild_lut()
+    /// never moves them: for transports that pack from an IRQ while the
+    /// setters may run. Call after set_depth16().
+    void reserve_luts();
+
+    /// Update the estimate from a packed frame's channel sum and, with a
+    /// budget set, adjust _lut_b for the next frame.
+    void limit_power(uint32_t sum);
+
+    /// Grow both staging buffers' dirty ranges by [lo, hi).
+    void mark_dirty(uint lo, uint hi);
+
+    uint            _count;
+    uint            _npx;             // pixels held in _buf/_buf16: _count, or 0 once released
+    bool            _rgbw;
+    uint            _bpp;             // bytes per pixel in _buf (3 or 4)
+    std::vector<uint8_t>  _buf;       // logical pixel buffer: R,G,B[,W] per pixel
+    bool            _byte_wire = false; // pack a byte stream instead of words
+    uint            _dirty_lo[2] = {0, 0}; // per staging buffer: pixels [lo, hi)
+    uint            _dirty_hi[2] = {0, 0}; // changed since it was last packed
+    uint8_t         _brightness = 255; // 0..255
+    const GammaTable* _gam[4];        // per channel R,G,B,W: shared tables in flash
+    RGBW            _balance = {255, 255, 255, 255}; // setWhiteBalance()
+    RGB             _temp = {255, 255, 255};         // setColorTemperature()
+    std::vector<uint8_t> _lut;        // gamma x balance x brightness: 256 entries per distinct channel
+    const uint8_t*  _lut_ch[4];       // R,G,B,W tables in _lut, used by build_frame
+    uint8_t         _lut_b = 255;     // brightness in _lut: _brightness, or less when power limited
+    uint32_t        _power_budget = 0; // mA, 0 = limiter off
+    uint16_t        _ma_per_ch = 20;   // mA per channel at full level
+    uint16_t        _idle_ma = 1;      // mA per LED at black
+    uint32_t        _est_ma = 0;       // estimate for the last packed frame
+    const detail::PackKernels* _kern; // packers for this colour order and format
+    bool            _depth16 = false;
+    std::vector<uint16_t> _buf16;     // depth16 pixel buffer (replaces _buf)
+    std::vector<uint16_t> _lut16;     // depth16: as _lut, 257 nodes per table, 8.8 fixed point
+    const uint16_t* _lut16_ch[4];
+    std::vector<uint8_t>  _dither_err; // depth16: residual per channel
+
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+    friend class Segment;
+};
+
+} // namespace ws
@@ -0,0 +1,105 @@
+#include "ws2812_player.hpp"
+
+#include <algorithm>
+#include "hardware/regs/addressmap.h"
+
+namespace ws {
+
+Player::Player(Strip& strip) : _strip(strip) {}
+
+Player::~Player() { stop(); }
+
+// Flash clips are streamed once per frame: read them through the XIP alias
+// that neither allocates nor hits cache lines, so code stays cached.
+static const uint32_t* dma_alias(const uint32_t* p) {
+#if PICO_RP2040
+    uintptr_t a = (uintptr_t)p;
+    if (a >= XIP_BASE && a < XIP_NOALLOC_BASE) // cached alias only; the others pass through
+        return reinterpret_cast<const uint32_t*>(a - XIP_BASE + XIP_NOCACHE_NOALLOC_BASE);
+#endif
+    return p;
+}
+
+bool Player::load(const void* clip) {
+    stop();
+    _hdr = nullptr;
+    _frame = 0;
+    // A blocking send would run the whole frame in the timer IRQ.
+    if (!_strip.hasDma()) return false;
+    const ClipHeader* h = static_cast<const ClipHeader*>(clip);
+    if (!h || ((uintptr_t)h & 3) || h->magic != CLIP_MAGIC || h->version != CLIP_VERSION) return false;
+    if (h->format != (uint8_t)(_strip.isRgbw() ? ClipFormat::Wire32 : ClipFormat::Wire24)) return false;
+    if (!h->fps || h->fps > 1000 || !h->frames || !h->pixels) return false;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(h + 1);
+    _levels = nullptr;
+    if (h->flags & CLIP_BRIGHTNESS) {
+        _levels = p;
+        p += (h->frames + 3) & ~3u;
+    }
+    _words = dma_alias(reinterpret_cast<const uint32_t*>(p));
+    _hdr = h;
+    return true;
+}
+
+bool Player::play(bool loop) {
+    if (!_hdr) return false;
+    if (_playing) { _loop = loop; return true; }
+    _loop = loop;
+    if (_frame >= _hdr->frames) _frame = 0;
+    _playing = true;
+    // Negative delay: period measured start to start, so the rate doesn't drift.
+    if (!add_repeating_timer_us(-(int64_t)(1000000u / _hdr->fps), tick, this, &_timer)) {
+        _playing = false;
+        return false;
+    }
+    return true;
+}
+
+void Player::stop() {
+    if (!_playing) return;
+    cancel_repeating_timer(&_timer);
+    _playing = false;
+    _strip.wait();
+}
+
+void Player::seek(uint32_t i) {
+    if (_hdr) _frame = std::min(i, _hdr->frames - 1);
+}
+
+bool Player::tick(repeating_timer_t* t) {
+    Player* p = static_cast<Player*>(t->user_data);
+    uint32_t i = p->_frame;
+    if (i >= p->_hdr->frames) {
+        if (!p->_loop) { p->_playing = false; return false; }
+        i = 0;
+    }
+    if (p->_strip.busy()) ++p->_dropped; // keep time: this frame is skipped
+    else p->show(i);
+    p->_frame = i + 1;
+    return true;
+}
+
+void Player::show(uint32_t i) {
+    const uint32_t n = std::min<uint32_t>(_hdr->pixels, _strip.size());
+    const uint32_t* src = _words + (size_t)i * _hdr->pixels;
+    uint s = _brightness;
+    if (_levels) {
+        uint y = s * _levels[i] + 128; // round(a * b / 255)
+        s = (y + (y >> 8)) >> 8;
+    }
+    uint32_t* out = s < 255 ? _strip.wireBuffer() : nullptr;
+    if (out) {
+        // Every byte of a word is one channel, whatever the colour order: scale
+        // the even and odd bytes with one multiply each (x * (s + 1) / 256).
+        const uint32_t m = s + 1;
+        for (uint32_t j = 0; j < n; ++j) {
+            uint32_t w = src[j];
+            out[j] = (((w & 0x00FF00FFu) * m >> 8) & 0x00FF00FFu) | (((w >> 8) & 0x00FF00FFu) * m & 0xFF00FF00u);
+        }
+        src = out;
+    }
+    _strip.send_from_irq(src, n); // DMA reads the frame where it is: flash or staging
+}
+
+} // namespace ws
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include "pico/time.h"
+#include "ws2812.hpp"
+
+namespace ws {
+
+/// Clip header magic: "WSCL" read as a little-endian word.
+static constexpr uint32_t CLIP_MAGIC   = 0x4C435357u;
+static constexpr uint8_t  CLIP_VERSION = 1;
+
+/// Wire word layout of a clip's frames (see PixelBuffer::pack()).
+enum class ClipFormat : uint8_t {
+    Wire24 = 0, ///< RGB strips: 24 data bits in 31..8, in the strip's colour order
+    Wire32 = 1, ///< RGBW strips: 32 data bits
+};
+
+/// ClipHeader::flags
+static constexpr uint8_t CLIP_BRIGHTNESS = 1u << 0; ///< a brightness byte per frame follows the header
+
+/**
+ * @brief On-flash clip layout: this header, then frames of ready-to-send wire words.
+ *
+ * @code
+ * ClipHeader                 20 bytes, stored little-endian
+ * uint8_t brightness[frames] with CLIP_BRIGHTNESS only, padded to 4 bytes
+ * uint32_t words[frames][pixels]
+ * @endcode
+ *
+ * The words are what the target strip would send, gamma and colour order
+ * included; bake them with PixelBuffer::pack() (the host build has it too).
+ * The clip must be 4-byte aligned.
+ */
+struct ClipHeader {
+    uint32_t magic;    ///< CLIP_MAGIC
+    uint8_t  version;  ///< CLIP_VERSION
+    uint8_t  format;   ///< ClipFormat
+    uint8_t  flags;    ///< CLIP_BRIGHTNESS
+    uint8_t  reserved;
+    uint16_t fps;      ///< playback rate (1..1000)
+    uint16_t reserved2;
+    uint32_t pixels;   ///< LEDs per frame
+    uint32_t frames;   ///< frame count
+};
+static_assert(sizeof(ClipHeader) == 20, "ClipHeader is an on-flash format");
+
+/**
+ * @brief Plays a pre-packed clip from flash (XIP), DMA reading the frames in place.
+ *
+ * A repeating timer fires at the clip's frame rate and hands the next frame
+ * to the strip as showFrom(const uint32_t*) would, but without waiting, as
+ * the tick runs in the timer IRQ: the CPU does nothing per pixel, and
+ * clips are limited by flash size, not SRAM. On RP2040 DMA reads through the
+ * non-allocating XIP alias, so playback doesn't evict code from the XIP cache.
+ *
+ * With brightness below 255 (setBrightness(), or a clip's per-frame table)
+ * frames are instead scaled into the strip's staging buffer (wireBuffer()),
+ * two multiplies per pixel in the timer IRQ; without staging (byte_wire,
+ * Options::stream, no pixel buffer) brightness is ignored. The strip's own
+ * brightness, gamma and power limiter never apply: frames are wire words.
+ *
+ * A tick that finds the previous frame still on the wire drops its frame,
+ * so playback keeps time (dropped()). The strip needs a DMA channel (load()
+ * refuses it otherwise). With Options::byte_wire every frame is unpacked into
+ * staging in the timer IRQ, a loop over every pixel.
+ *
+ * Threading: while playing, the timer IRQ owns the strip's show calls.
+ */
+class Player {
+public:
+    /// @param strip A begun Strip; must outlive the player.
+    explicit Player(Strip& strip);
+
+    /// @brief Calls stop().
+    ~Player();
+
+    /**
+     * @brief Check and select a clip (stops playback, rewinds).
+     * @param clip A ClipHeader followed by its data, usually a const array in flash.
+     * @return false if misaligned, of another version, its format doesn't
+     *         match the strip (Wire32 on RGBW strips), or the strip has no DMA
+     *         channel (not begun, or blocking sends).
+     */
+    bool load(const void* clip);
+
+    /**
+     * @brief Start (or resume) playback from frame().
+     * @param loop Wrap to frame 0 after the last frame; otherwise stop there.
+     * @return false if no clip is loaded or no timer slot is free.
+     */
+    bool play(bool loop = true);
+
+    /// @brief Stop after the frame on the wire. frame() stays where it was.
+    void stop();
+
+    /// @brief Continue from frame i (clamped) on the next tick.
+    void seek(uint32_t i);
+
+    /// @brief Scale every frame by b / 255 (on top of the clip's own table). 255 = zero-copy.
+    inline void setBrightness(uint8_t b) { _brightness = b; }
+
+    inline bool playing() const { return _playing; }
+    /// @brief Index of the next frame to be shown.
+    inline uint32_t frame() const { return _frame; }
+    inline uint32_t frames() const { return _hdr ? _hdr->frames : 0; }
+    inline uint fps() const { return _hdr ? _hdr->fps : 0; }
+
+    /// @brief Frames skipped because the previous one was still on the wire.
+    inline uint32_t dropped() const { return _dropped; }
+
+private:
+    static bool tick(repeating_timer_t* t);
+    void show(uint32_t i);
+
+    Strip&               _strip;
+    const ClipHeader*    _hdr = nullptr;
+    const uint8_t*       _levels = nullptr; // per-frame brightness, or nullptr
+    const uint32_t*      _words = nullptr;  // frame 0, DMA-readable alias
+    repeating_timer_t    _timer = {};
+    volatile uint32_t    _frame = 0;
+    volatile uint32_t    _dropped = 0;
+    volatile bool        _playing = false;
+    bool                 _loop = true;
+    volatile uint8_t     _brightness = 255;
+
+    Player(const Player&) = delete;
+    Player& operator=(const Player&) = delete;
+};
+
+} // namespace ws
@@ -0,0 +1,72 @@
+#include "ws2812_resources.hpp"
+#include <cstring>
+
+namespace ws {
+namespace detail {
+
+// Per PIO block, at most one slot per loaded program; 32 instructions hold
+// at most 8 of our 4-instruction programs.
+struct ProgramSlot {
+    uint16_t insn[MAX_SHARED_PROGRAM_LEN];
+    uint8_t  length;   // 0 = free
+    int8_t   origin;
+    uint8_t  offset;
+    uint8_t  refs;
+};
+static constexpr uint SLOTS_PER_PIO = PIO_INSTRUCTION_COUNT / 4;
+static ProgramSlot s_slots[NUM_PIOS][SLOTS_PER_PIO] = {};
+
+static pio_program_t as_program(const ProgramSlot& s) {
+    pio_program_t p = {};
+    p.instructions = s.insn;
+    p.length = s.length;
+    p.origin = s.origin;
+    return p;
+}
+
+int program_acquire(PIO pio, const pio_program_t* prog) {
+    if (prog->length == 0 || prog->length > MAX_SHARED_PROGRAM_LEN) return -1;
+    ProgramSlot* slots = s_slots[pio_get_index(pio)];
+    ProgramSlot* free_slot = nullptr;
+    for (uint i=0;i<SLOTS_PER_PIO;++i) {
+        ProgramSlot& s = slots[i];
+        if (!s.length) { if (!free_slot) free_slot = &s; continue; }
+        if (s.length == prog->length && s.origin == prog->origin &&
+            std::memcmp(s.insn, prog->instructions, prog->length * sizeof(uint16_t)) == 0) {
+            ++s.refs;
+            return s.offset;
+        }
+    }
+    // pio_add_program() panics when it doesn't fit: check first.
+    if (!free_slot || !pio_can_add_program(pio, prog)) return -1;
+    free_slot->offset = (uint8_t)pio_add_program(pio, prog);
+    std::memcpy(free_slot->insn, prog->instructions, prog->length * sizeof(uint16_t));
+    free_slot->length = prog->length;
+    free_slot->origin = prog->origin;
+    free_slot->refs = 1;
+    return free_slot->offset;
+}
+
+void program_release(PIO pio, uint offset) {
+    ProgramSlot* slots = s_slots[pio_get_index(pio)];
+    for (uint i=0;i<SLOTS_PER_PIO;++i) {
+        ProgramSlot& s = slots[i];
+        if (!s.length || s.offset != offset) continue;
+        if (--s.refs == 0) {
+            pio_program_t p = as_program(s);
+            pio_remove_program(pio, &p, offset);
+            s.length = 0;
+        }
+        return;
+    }
+}
+
+int sm_claim(PIO pio, int sm) {
+    if (sm < 0) return pio_claim_unused_sm(pio, false);
+    if (sm >= NUM_PIO_STATE_MACHINES || pio_sm_is_claimed(pio, (uint)sm)) return -1;
+    pio_sm_claim(pio, (uint)sm);
+    return sm;
+}
+
+} // namespace detail
+} // namespace ws
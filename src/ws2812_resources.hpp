@@ -0,0 +1,29 @@
+#pragma once
+// PIO program sharing between driver instances. Not part of the public API.
+#include "hardware/pio.h"
+
+namespace ws {
+namespace detail {
+
+/// Longest program the registry takes (the ws2812 programs are 4 instructions).
+static constexpr uint MAX_SHARED_PROGRAM_LEN = 8;
+
+/**
+ * Load `prog` into `pio` unless an identical program (same instructions and
+ * origin) is already loaded there, and take a reference to it.
+ * Each PIO block (pio0..pio2 on RP2350) is tracked separately.
+ * @return offset, or -1 if instruction memory or the registry is full.
+ */
+int program_acquire(PIO pio, const pio_program_t* prog);
+
+/// Drop a reference taken by program_acquire(); the last one removes the program.
+void program_release(PIO pio, uint offset);
+
+/**
+ * Claim state machine `sm` (>= 0) or any free one (-1) without panicking.
+ * @return the claimed SM, or -1 if taken / none free.
+ */
+int sm_claim(PIO pio, int sm);
+
+} // namespace detail
+} // namespace ws
@@ -0,0 +1,362 @@
+#include "ws2812_segment.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Blend/fade kernels on the calling core's interpolator 0 (blend mode);
+// the portable fallback is a software lerp rounding down.
+#ifndef WS2812_USE_INTERP
+#if defined(WS2812_HOST) && WS2812_HOST
+#define WS2812_USE_INTERP 0
+#else
+#define WS2812_USE_INTERP 1
+#endif
+#endif
+
+#if WS2812_USE_INTERP
+#include "hardware/interp.h"
+#endif
+
+namespace ws {
+
+namespace {
+
+// Logical pixels of a view in the strip's native storage (uint8_t or uint16_t).
+template<class T>
+struct View {
+    using type = T;
+    T*        p;     // logical pixel 0
+    ptrdiff_t step;  // elements from one logical pixel to the next (< 0: reversed)
+    uint      n, c;  // pixels, channels per pixel (3/4)
+
+    inline T* at(uint i) const { return p + (ptrdiff_t)i * step; }
+    /// Stride 1: the pixels are one block starting at `lo()`.
+    inline bool dense() const { return step == (ptrdiff_t)c || step == -(ptrdiff_t)c; }
+    inline T* lo() const { return step > 0 ? p : at(n - 1); }
+};
+
+// One pixel in native units (0..255 or 0..65535 per channel).
+template<class T> struct Px { T v[4]; };
+
+template<class T> inline Px<T> native(RGBW c) {
+    constexpr uint k = sizeof(T) == 2 ? 257 : 1;
+    return Px<T>{{T(c.r * k), T(c.g * k), T(c.b * k), T(c.w * k)}};
+}
+template<class T> inline Px<T> native(const RGBW16& c) {
+    constexpr uint s = sizeof(T) == 2 ? 0 : 8;
+    return Px<T>{{T(c.r >> s), T(c.g >> s), T(c.b >> s), T(c.w >> s)}};
+}
+template<class T> inline RGBW16 wide(const T* p, uint c) {
+    constexpr uint k = sizeof(T) == 2 ? 1 : 257;
+    return RGBW16{uint16_t(p[0] * k), uint16_t(p[1] * k), uint16_t(p[2] * k), uint16_t(c == 4 ? p[3] * k : 0)};
+}
+template<class T> inline void put(T* p, uint c, const Px<T>& v) {
+    p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2];
+    if (c == 4) p[3] = v.v[3];
+}
+
+// a + (b - a) * t / 256 per channel, for one bulk operation at a fixed t
+// (1..254; callers handle 0 and 255 so the endpoints are exact).
+#if WS2812_USE_INTERP
+// interp0 lane 1 in blend mode: two SIO stores and a load per channel in
+// place of subtract, multiply, shift and add. The core's interp0 state is
+// saved for the lifetime of the object, so user code using it is unaffected.
+class Lerp {
+public:
+    explicit Lerp(uint t) {
+        interp_save(interp0, &_saved);
+        interp_config c = interp_default_config();
+        interp_config_set_blend(&c, true);
+        interp_set_config(interp0, 0, &c);
+        c = interp_default_config();
+        interp_set_config(interp0, 1, &c);
+        interp0->accum[1] = t; // alpha
+    }
+    ~Lerp() { interp_restore(interp0, &_saved); }
+    inline uint operator()(uint a, uint b) const {
+        interp0->base[0] = a;
+        interp0->base[1] = b;
+        return interp0->peek[1];
+    }
+private:
+    interp_hw_save_t _saved;
+    Lerp(const Lerp&) = delete;
+    Lerp& operator=(const Lerp&) = delete;
+};
+#else
+class Lerp {
+public:
+    explicit Lerp(uint t) : _t(t) {}
+    inline uint operator()(uint a, uint b) const {
+        // a + floor((b - a) * t / 256), without shifting a negative value
+        return (a * (256u - _t) + b * _t) >> 8;
+    }
+private:
+    uint _t;
+};
+#endif
+
+template<class T> void fill_px(const View<T>& v, const Px<T>& c) {
+    for (uint i=0;i<v.n;++i) put(v.at(i), v.c, c);
+}
+
+template<class T> void swap_px(const View<T>& v, uint i, uint j) {
+    T *a = v.at(i), *b = v.at(j);
+    for (uint k=0;k<v.c;++k) std::swap(a[k], b[k]);
+}
+
+template<class T> void reverse_px(const View<T>& v, uint i, uint j) { // [i, j)
+    while (i + 1 < j) swap_px(v, i++, --j);
+}
+
+template<class T> void shift_px(View<T> v, int k, const Px<T>& f) {
+    if (!k) return;
+    const uint a = (uint)(k < 0 ? -k : k);
+    if (a >= v.n) { fill_px(v, f); return; }
+    if (v.dense()) {
+        // One memmove in physical order; reversed views move the other way.
+        T* lo = v.lo();
+        const size_t keep = (size_t)(v.n - a) * v.c * sizeof(T);
+        if ((k > 0) == (v.step > 0)) std::memmove(lo + (size_t)a * v.c, lo, keep);
+        else                         std::memmove(lo, lo + (size_t)a * v.c, keep);
+    } else if (k > 0) {
+        for (uint i=v.n-1;i>=a;--i) std::memcpy(v.at(i), v.at(i - a), v.c * sizeof(T));
+    } else {
+        for (uint i=0;i+a<v.n;++i) std::memcpy(v.at(i), v.at(i + a), v.c * sizeof(T));
+    }
+    View<T> in = v;
+    in.n = a;
+    if (k < 0) in.p = v.at(v.n - a);
+    fill_px(in, f);
+}
+
+template<class T> void rotate_px(const View<T>& v, int k) {
+    if (v.n < 2) return;
+    const uint r = (uint)(((k % (int)v.n) + (int)v.n) % (int)v.n); // towards the end
+    if (!r) return;
+    if (v.dense()) {
+        T* lo = v.lo();
+        const uint d = v.step > 0 ? r : v.n - r; // physical pixels towards the end
+        std::rotate(lo, lo + (size_t)(v.n - d) * v.c, lo + (size_t)v.n * v.c);
+    } else {
+        reverse_px(v, 0, v.n);
+        reverse_px(v, 0, r);
+        reverse_px(v, r, v.n);
+    }
+}
+
+template<class T> void blend_px(const View<T>& v, const Px<T>& c, uint t) {
+    const Lerp lerp(t);
+    if (v.dense()) {
+        // One block: walk channels in memory order, the colour repeating every c.
+        T* p = v.lo();
+        for (uint i=0;i<v.n;++i, p+=v.c)
+            for (uint k=0;k<v.c;++k) p[k] = (T)lerp(p[k], c.v[k]);
+        return;
+    }
+    for (uint i=0;i<v.n;++i) {
+        T* p = v.at(i);
+        for (uint k=0;k<v.c;++k) p[k] = (T)lerp(p[k], c.v[k]);
+    }
+}
+
+// v[i] = a[i] + (b[i] - a[i]) * t / 256 for caller pixels of Stride bytes.
+template<class T, uint Stride> void mix_px(const View<T>& v, const uint8_t* a, const uint8_t* b, uint t) {
+    constexpr uint k = sizeof(T) == 2 ? 257 : 1;
+    const Lerp lerp(t);
+    const uint C = std::min(v.c, Stride);
+    for (uint i=0;i<v.n;++i, a+=Stride, b+=Stride) {
+        T* p = v.at(i);
+        for (uint j=0;j<C;++j) p[j] = (T)(lerp(a[j], b[j]) * k);
+        if (v.c > C) p[3] = 0;
+    }
+}
+
+template<class T, class S> void copy_px(const View<T>& v, const S* src, uint n) {
+    constexpr uint SC = sizeof(S);
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+    if (sizeof(T) == 1 && SC == v.c && v.step == (ptrdiff_t)v.c) {
+        std::memcpy(v.p, s, (size_t)n * SC);
+        return;
+    }
+    constexpr uint k = sizeof(T) == 2 ? 257 : 1;
+    for (uint i=0;i<n;++i, s+=SC) {
+        T* p = v.at(i);
+        p[0] = T(s[0] * k); p[1] = T(s[1] * k); p[2] = T(s[2] * k);
+        if (v.c == 4) p[3] = SC == 4 ? T(s[3] * k) : 0;
+    }
+}
+
+} // namespace
+
+bool Segment::fits(uint i0, uint n) const {
+    // The strip may have dropped its pixels since construction (begin() with
+    // Options::pixel_buffer = false): then every view is empty.
+    return n && std::max(index(i0), index(i0 + n - 1)) < _strip._npx;
+}
+
+template<class Fn>
+bool Segment::visit(uint i0, uint n, Fn&& fn) const {
+    if (!fits(i0, n)) return false;
+    const uint bpp = _strip._bpp;
+    const ptrdiff_t step = (_rev ? -(ptrdiff_t)_stride : (ptrdiff_t)_stride) * (ptrdiff_t)bpp;
+    const size_t at = (size_t)index(i0) * bpp;
+    if (_strip._depth16) fn(View<uint16_t>{&_strip._buf16[at], step, n, bpp});
+    else                 fn(View<uint8_t>{&_strip._buf[at], step, n, bpp});
+    return true;
+}
+
+template<class Fn>
+void Segment::read(uint m, bool whole, Fn&& fn) const {
+    // Small chunks on the stack; the whole view when writes could alias it.
+    constexpr uint CHUNK = 32;
+    RGBW16 stack[CHUNK];
+    std::vector<RGBW16> all(whole ? m : 0);
+    RGBW16* px = whole ? all.data() : stack;
+    for (uint i0=0;i0<m;) {
+        const uint n = whole ? m : std::min(CHUNK, m - i0);
+        if (!visit(i0, n, [&](auto v) { for (uint i=0;i<n;++i) px[i] = wide(v.at(i), v.c); }))
+            std::fill(px, px + n, RGBW16{0, 0, 0, 0});
+        fn(i0, n, px);
+        i0 += n;
+    }
+}
+
+Segment::Segment(PixelBuffer& strip, uint offset, uint length, bool reverse, uint stride)
+: _strip(strip), _off(offset), _len(0), _stride(stride ? stride : 1), _rev(reverse)
+{
+    if (offset < strip._npx)
+        _len = std::min(length, (strip._npx - offset + _stride - 1) / _stride);
+}
+
+bool Segment::overlaps(const Segment& o, uint m) const {
+    if (&o._strip != &_strip || !m) return false;
+    const uint a0 = std::min(index(0), index(m - 1)), a1 = std::max(index(0), index(m - 1));
+    const uint b0 = std::min(o.index(0), o.index(m - 1)), b1 = std::max(o.index(0), o.index(m - 1));
+    return a0 <= b1 && b0 <= a1;
+}
+
+void Segment::touch(uint i0, uint i1) {
+    if (i0 >= i1 || !fits(i0, i1 - i0)) return;
+    const uint a = index(i0), b = index(i1 - 1);
+    _strip.mark_dirty(std::min(a, b), std::max(a, b) + 1);
+}
+
+void Segment::set(uint i, RGBW c) {
+    if (i >= _len) return;
+    visit(i, 1, [&](auto v) { put(v.p, v.c, native<typename decltype(v)::type>(c)); });
+    touch(i, i + 1);
+}
+
+RGBW Segment::get(uint i) const {
+    RGBW16 c{0, 0, 0, 0};
+    if (i < _len) visit(i, 1, [&](auto v) { c = wide(v.p, v.c); });
+    return RGBW{uint8_t(c.r >> 8), uint8_t(c.g >> 8), uint8_t(c.b >> 8), uint8_t(c.w >> 8)};
+}
+
+void Segment::fill(RGBW c) {
+    visit(0, _len, [&](auto v) { fill_px(v, native<typename decltype(v)::type>(c)); });
+    touch(0, _len);
+}
+
+void Segment::fill(RGBW16 c) {
+    visit(0, _len, [&](auto v) { fill_px(v, native<typename decltype(v)::type>(c)); });
+    touch(0, _len);
+}
+
+void Segment::copy(const RGB* src, size_t n) {
+    const uint m = (uint)std::min(n, (size_t)_len);
+    visit(0, m, [&](auto v) { copy_px(v, src, m); });
+    touch(0, m);
+}
+
+void Segment::copy(const RGBW* src, size_t n) {
+    const uint m = (uint)std::min(n, (size_t)_len);
+    visit(0, m, [&](auto v) { copy_px(v, src, m); });
+    touch(0, m);
+}
+
+void Segment::copy(const Segment& src) {
+    const uint m = std::min(_len, src._len);
+    if (!m) return;
+    if (&src._strip == &_strip && !_rev && !src._rev && _stride == 1 && src._stride == 1) {
+        // Forward runs of one strip: a single memmove, overlapping or not.
+        src.visit(0, m, [&](auto s) {
+            visit(0, m, [&](auto d) {
+                std::memmove((void*)d.p, s.p, (size_t)m * d.c * sizeof(*s.p));
+            });
+        });
+    } else {
+        src.read(m, overlaps(src, m), [&](uint i0, uint n, const RGBW16* px) {
+            visit(i0, n, [&](auto v) {
+                using T = typename decltype(v)::type;
+                for (uint i=0;i<n;++i) put(v.at(i), v.c, native<T>(px[i]));
+            });
+        });
+    }
+    touch(0, m);
+}
+
+void Segment::shift(int n, RGBW fill) {
+    visit(0, _len, [&](auto v) { shift_px(v, n, native<typename decltype(v)::type>(fill)); });
+    touch(0, _len);
+}
+
+void Segment::rotate(int n) {
+    visit(0, _len, [&](auto v) { rotate_px(v, n); });
+    touch(0, _len);
+}
+
+void Segment::blend(RGBW c, uint8_t amount) {
+    if (!amount) return;
+    if (amount == 255) { fill(c); return; }
+    visit(0, _len, [&](auto v) { blend_px(v, native<typename decltype(v)::type>(c), amount); });
+    touch(0, _len);
+}
+
+void Segment::blend(const Segment& src, uint8_t amount) {
+    const uint m = std::min(_len, src._len);
+    if (!m || !amount) return;
+    if (amount == 255) { copy(src); return; }
+    src.read(m, overlaps(src, m), [&](uint i0, uint n, const RGBW16* px) {
+        visit(i0, n, [&](auto v) {
+            using T = typename decltype(v)::type;
+            const Lerp lerp(amount);
+            for (uint i=0;i<n;++i) {
+                T* p = v.at(i);
+                const Px<T> c = native<T>(px[i]);
+                for (uint k=0;k<v.c;++k) p[k] = (T)lerp(p[k], c.v[k]);
+            }
+        });
+    });
+    touch(0, m);
+}
+
+void Segment::blend(const RGB* a, const RGB* b, size_t n, uint8_t t) {
+    if (t == 0) { copy(a, n); return; }
+    if (t == 255) { copy(b, n); return; }
+    const uint m = (uint)std::min(n, (size_t)_len);
+    visit(0, m, [&](auto v) {
+        mix_px<typename decltype(v)::type, 3>(v, &a->r, &b->r, t);
+    });
+    touch(0, m);
+}
+
+void Segment::blend(const RGBW* a, const RGBW* b, size_t n, uint8_t t) {
+    if (t == 0) { copy(a, n); return; }
+    if (t == 255) { copy(b, n); return; }
+    const uint m = (uint)std::min(n, (size_t)_len);
+    visit(0, m, [&](auto v) {
+        mix_px<typename decltype(v)::type, 4>(v, &a->r, &b->r, t);
+    });
+    touch(0, m);
+}
+
+void Segment::nscale8(uint8_t scale) {
+    if (scale == 255) return;
+    if (scale == 0) { fill(RGBW{0, 0, 0, 0}); return; }
+    visit(0, _len, [&](auto v) { blend_px(v, Px<typename decltype(v)::type>{{0, 0, 0, 0}}, 255u - scale); });
+    touch(0, _len);
+}
+
+} // namespace ws
@@ -0,0 +1,131 @@
+#pragma once
+// Zone views over a PixelBuffer. SDK-free.
+#include <cstddef>
+#include <cstdint>
+#include "ws2812_pixels.hpp"
+
+namespace ws {
+
+/**
+ * @brief A view of `length` pixels of a strip: offset, optional reverse and stride.
+ *
+ * Logical pixel i is physical pixel offset + i * stride, or counted from the
+ * far end with reverse (for a zone wired back to front, or folded strips).
+ * Views are a few words of state and may overlap; every operation works on
+ * the strip's pixel buffer directly (8- or 16-bit, see Options::depth16) as
+ * one tight loop, or memcpy/memmove when stride is 1, and grows the dirty
+ * range by just the pixels touched, so show() repacks only changed zones.
+ *
+ * @code
+ * ws::Segment left(strip, 0, 600), right(strip, 600, 600, true); // mirrored halves
+ * left.fill(ws::RGB{0, 0, 40});
+ * right.copy(left);      // reversed copy
+ * right.rotate(1);
+ * @endcode
+ *
+ * Length is cut at construction to what fits the strip. It references the
+ * strip, which must outlive it; changing the strip's depth (begin()) is
+ * fine. If begin() drops the pixel buffer (Options::pixel_buffer = false),
+ * views built before stay valid and every operation does nothing (get()
+ * returns black).
+ */
+class Segment {
+public:
+    Segment(PixelBuffer& strip, uint offset, uint length, bool reverse = false, uint stride = 1);
+
+    /// @brief Number of pixels in the view.
+    inline uint size() const { return _len; }
+
+    /// @brief Physical index of logical pixel i (i < size()).
+    inline uint index(uint i) const { return _off + (_rev ? _len - 1 - i : i) * _stride; }
+
+    /// @brief Set one pixel. Out-of-range indices are ignored.
+    void set(uint i, RGBW c);
+    inline void set(uint i, RGB c) { set(i, RGBW{c.r, c.g, c.b, 0}); }
+
+    /// @brief Read one pixel back (8 bits per channel; black if out of range).
+    RGBW get(uint i) const;
+
+    /// @brief Set every pixel of the view.
+    void fill(RGBW c);
+    inline void fill(RGB c) { fill(RGBW{c.r, c.g, c.b, 0}); }
+    void fill(RGBW16 c);
+
+    /**
+     * @brief Copy caller pixels into logical pixels 0..n-1 (n clamped to size()).
+     *
+     * A memcpy on RGB/RGBW strips fed their own pixel type with stride 1.
+     */
+    void copy(const RGB* src, size_t n);
+    void copy(const RGBW* src, size_t n);
+
+    /**
+     * @brief Copy another view, logical pixel by logical pixel (min of both sizes).
+     *
+     * src may be on another strip and may overlap this view; a copy between
+     * forward stride-1 views of one strip is a single memmove.
+     */
+    void copy(const Segment& src);
+
+    /**
+     * @brief Move pixels by n positions towards the end (n < 0: towards the start).
+     * @param fill Colour of the pixels shifted in.
+     */
+    void shift(int n, RGBW fill = RGBW{0, 0, 0, 0});
+
+    /// @brief Move pixels by n positions towards the end, wrapping around.
+    void rotate(int n);
+
+    /**
+     * @brief Mix every pixel towards c: amount 0 keeps it, 255 gives c.
+     *
+     * p + (c - p) * amount / 256 per channel, on the RP2040/RP2350
+     * interpolator (see WS2812_USE_INTERP); 0 and 255 are exact.
+     * The software fallback rounds down; the interpolator's rounding when
+     * c < p may differ from it by one step.
+     */
+    void blend(RGBW c, uint8_t amount);
+
+    /// @brief Crossfade towards another view (min of both sizes); src may overlap.
+    void blend(const Segment& src, uint8_t amount);
+
+    /**
+     * @brief Crossfade two caller frames into the view: a at t = 0, b at t = 255.
+     *
+     * One pass writing straight into the pixel buffer, n clamped to size().
+     */
+    void blend(const RGB* a, const RGB* b, size_t n, uint8_t t);
+    void blend(const RGBW* a, const RGBW* b, size_t n, uint8_t t);
+
+    /// @brief Scale every channel by (scale + 1) / 256, rounded down (255 keeps
+    /// the pixels, 0 is black).
+    void nscale8(uint8_t scale);
+
+    /// @brief Scale every channel by (256 - amount) / 256, rounded down (0 keeps
+    /// the pixels, 255 is black).
+    inline void fadeToBlackBy(uint8_t amount) { nscale8(255 - amount); }
+
+private:
+    /// Are logical pixels [i0, i0 + n) in the strip's pixel buffer (n > 0)?
+    bool fits(uint i0, uint n) const;
+
+    /// Run fn on a view of logical pixels [i0, i0 + n) in the strip's
+    /// native storage (8-bit, or 16-bit with depth16). false (fn not run)
+    /// if they are not in the buffer.
+    template<class Fn> bool visit(uint i0, uint n, Fn&& fn) const;
+
+    /// Pass the first m pixels as RGBW16 to fn(i0, n, px) a chunk at a time.
+    template<class Fn> void read(uint m, bool whole, Fn&& fn) const;
+
+    /// Do the first m pixels of both views share physical pixels?
+    bool overlaps(const Segment& o, uint m) const;
+
+    /// Mark logical pixels [i0, i1) dirty.
+    void touch(uint i0, uint i1);
+
+    PixelBuffer& _strip;
+    uint         _off, _len, _stride;
+    bool         _rev;
+};
+
+} // namespace ws
@@ -0,0 +1,101 @@
+#include "ws2812_stream.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+
+namespace ws {
+
+// Transfer count per arming of the UART DMA channel. Fits the 28-bit count
+// field of RP2350 (whose top bits select a mode); poll() re-arms at half.
+static constexpr uint32_t RX_ARM_COUNT = 0x0FFFFFFFu;
+
+StreamSource::StreamSource(Strip& strip)
+: _strip(strip), _parser(strip.size(), deliver, &strip) {}
+
+StreamSource::~StreamSource() { end(); }
+
+bool StreamSource::beginUart(uart_inst_t* uart, uint rx_pin, uint baud, uint ring_bits) {
+    end();
+    ring_bits = std::min(std::max(ring_bits, 8u), 15u);
+    const size_t ring_size = (size_t)1 << ring_bits;
+
+    int ch = dma_claim_unused_channel(false);
+    if (ch < 0) return false;
+    // DMA ring wrap needs the buffer aligned to its size.
+    _ring = static_cast<uint8_t*>(std::aligned_alloc(ring_size, ring_size));
+    if (!_ring) { dma_channel_unclaim((uint)ch); return false; }
+    _dma_ch = ch;
+    _ring_mask = (uint32_t)ring_size - 1;
+    _rd = _rx_base = 0;
+    reset();
+
+    uart_init(uart, baud);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+
+    dma_channel_config c = dma_channel_get_default_config((uint)ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, ring_bits);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, false));
+    dma_channel_configure((uint)ch, &c, _ring, &uart_get_hw(uart)->dr, RX_ARM_COUNT, true);
+    return true;
+}
+
+void StreamSource::end() {
+    if (_dma_ch >= 0) {
+        dma_channel_abort((uint)_dma_ch);
+        dma_channel_unclaim((uint)_dma_ch);
+        _dma_ch = -1;
+    }
+    std::free(_ring);
+    _ring = nullptr;
+}
+
+uint32_t StreamSource::received() const {
+    uint32_t left = dma_channel_hw_addr((uint)_dma_ch)->transfer_count & RX_ARM_COUNT;
+    return _rx_base + (RX_ARM_COUNT - left);
+}
+
+void StreamSource::rearm() {
+    // The UART FIFO (32 bytes) covers the few cycles the channel is stopped;
+    // write_addr carries on where it was, inside the ring.
+    dma_channel_abort((uint)_dma_ch);
+    _rx_base = received();
+    dma_channel_set_trans_count((uint)_dma_ch, RX_ARM_COUNT, true);
+}
+
+void StreamSource::poll() {
+    if (_dma_ch < 0) return;
+    if ((dma_channel_hw_addr((uint)_dma_ch)->transfer_count & RX_ARM_COUNT) < RX_ARM_COUNT / 2) rearm();
+
+    const uint32_t ring_size = _ring_mask + 1;
+    uint32_t avail = received() - _rd;
+    if (avail > ring_size) {
+        // Lapped: the oldest data is gone, so is any frame in progress.
+        ++_overruns;
+        _rd += avail;
+        reset();
+        return;
+    }
+    while (avail) {
+        uint32_t pos = _rd & _ring_mask;
+        uint32_t chunk = std::min(avail, ring_size - pos);
+        uint32_t used = (uint32_t)_parser.consume(_ring + pos, chunk, ring_size - pos);
+        _rd += used;
+        if (used < chunk) break; // waiting for the rest of a contiguous frame
+        avail -= chunk;
+    }
+}
+
+void StreamSource::feed(const uint8_t* data, size_t n) {
+    _parser.feed(data, n);
+}
+
+void StreamSource::deliver(void* ctx, const RGB* px, uint n) {
+    static_cast<Strip*>(ctx)->showFrom(px, n);
+}
+
+} // namespace ws
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include "hardware/uart.h"
+#include "ws2812.hpp"
+#include "ws2812_adalight.hpp"
+
+namespace ws {
+
+/**
+ * @brief Live pixel stream ingest: Adalight frames from UART (DMA) or USB CDC into a Strip.
+ *
+ * Frame format (Adalight, as sent by Hyperion, Prismatik, Art-Net bridges…):
+ * "Ada", count hi, count lo, hi ^ lo ^ 0x55, then (count + 1) R,G,B triplets.
+ *
+ * Each completed frame goes straight to Strip::showFrom(const RGB*, n), so
+ * brightness/gamma/power limiting still apply and the strip's own pixel
+ * buffer is left alone. Only the 6 header bytes are parsed one by one; the
+ * payload is handed over in bulk:
+ * - UART: a DMA channel writes the RX FIFO into a ring buffer with no CPU
+ *   involvement; poll() parses whatever has landed. A frame contiguous in the
+ *   ring is packed directly from it, one that wraps is first memcpy'd
+ *   together.
+ * - feed(): for data already in memory (tud_cdc_read(), a network stack).
+ *   A frame fully inside one chunk is packed directly from the chunk.
+ *
+ * Ingest overlaps output: DMA (or the USB stack) keeps receiving while a
+ * frame is on the wire. With Strip::Options::double_buffer the next frame
+ * is also packed while the previous one is still sending.
+ *
+ * Frames longer than the strip are cut to size(); bytes past it are skipped.
+ * A bad header checksum drops the frame and resynchronizes on the next "Ada".
+ * The parsing itself is AdalightParser (SDK-free, tested on the host).
+ *
+ * Threading: call poll()/feed() from one context; it owns the strip's show
+ * calls while streaming.
+ */
+class StreamSource {
+public:
+    /// @param strip A begun Strip; must outlive the source.
+    explicit StreamSource(Strip& strip);
+
+    /// @brief Calls end().
+    ~StreamSource();
+
+    /**
+     * @brief Receive from a UART through a DMA ring buffer.
+     * @param uart      uart0/uart1; initialized here at `baud`.
+     * @param rx_pin    GPIO switched to the UART RX function.
+     * @param baud      Line rate. 40 fps of 300 LEDs is ~36 kB/s, i.e. ≥460800 baud.
+     * @param ring_bits Ring size as log2 bytes (8..15). poll() must run at least
+     *                  once per ring's worth of data (4 KB = ~40 ms at 1 Mbaud).
+     * @return false if no DMA channel is free or the ring can't be allocated.
+     */
+    bool beginUart(uart_inst_t* uart, uint rx_pin, uint baud, uint ring_bits = 12);
+
+    /// @brief Stop UART DMA and free the ring. feed() keeps working.
+    void end();
+
+    /**
+     * @brief Parse everything the UART DMA has received since the last call.
+     *
+     * Sends every frame completed in it. Call from the main loop; without
+     * beginUart() this does nothing.
+     */
+    void poll();
+
+    /**
+     * @brief Parse a chunk of stream data (e.g. from tud_cdc_read()).
+     *
+     * Sends every frame completed in it. data may be reused on return.
+     */
+    void feed(const uint8_t* data, size_t n);
+
+    /// @brief Drop any partial frame and wait for the next header.
+    inline void reset() { _parser.reset(); }
+
+    /// @brief Frames sent since construction.
+    inline uint32_t frames() const { return _parser.frames(); }
+
+    /// @brief Headers rejected for a bad checksum.
+    inline uint32_t errors() const { return _parser.errors(); }
+
+    /// @brief Times poll() ran too late and the DMA ring was overwritten.
+    inline uint32_t overruns() const { return _overruns; }
+
+private:
+    /// AdalightParser::FrameFn: showFrom() on the strip.
+    static void deliver(void* ctx, const RGB* px, uint n);
+
+    /// Bytes the UART DMA has written since beginUart() (wraps at 2^32).
+    uint32_t received() const;
+    void rearm();
+
+    Strip&               _strip;
+    AdalightParser       _parser;
+
+    int                  _dma_ch = -1;
+    uint8_t*             _ring = nullptr;  // aligned to its size for DMA ring wrap
+    uint32_t             _ring_mask = 0;
+    uint32_t             _rd = 0;          // bytes consumed (wraps at 2^32)
+    uint32_t             _rx_base = 0;     // bytes received before the current arming
+
+    uint32_t             _overruns = 0;
+
+    StreamSource(const StreamSource&) = delete;
+    StreamSource& operator=(const StreamSource&) = delete;
+};
+
+} // namespace ws
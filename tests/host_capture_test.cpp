@@ -0,0 +1,370 @@
+// Host build golden-frame checks (ctest): the real packer, Segment views and
+// compressed frames against known wire words. No test framework: a failed
+// CHECK prints the line and the test exits non-zero.
+#include <cstdio>
+#include <vector>
+#include "ws2812_adalight.hpp"
+#include "ws2812_capture.hpp"
+#include "ws2812_frame.hpp"
+#include "ws2812_segment.hpp"
+
+static int s_failed = 0;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); ++s_failed; } } while (0)
+
+using Words = std::vector<uint32_t>;
+
+static const Words& last(const ws::CaptureStrip& s) { return s.frames().back(); }
+
+// One word per pixel, first byte sent in bits 31..24, RGB strips in 31..8.
+static void test_orders() {
+    ws::CaptureStrip grb(2);
+    grb.begin();
+    grb.setPixel(0, ws::RGB{1, 2, 3});
+    grb.setPixel(1, ws::RGB{0xAA, 0xBB, 0xCC});
+    grb.show();
+    CHECK(last(grb) == (Words{0x02010300u, 0xBBAACC00u}));
+
+    ws::CaptureStrip rgb(1, false, ws::ColorOrder::RGB);
+    rgb.begin();
+    rgb.setPixel(0, ws::RGB{1, 2, 3});
+    rgb.show();
+    CHECK(last(rgb) == (Words{0x01020300u}));
+
+    ws::CaptureStrip grbw(1, true);
+    grbw.begin();
+    grbw.setPixel(0, ws::RGBW{1, 2, 3, 4});
+    grbw.show();
+    CHECK(last(grbw) == (Words{0x02010304u}));
+}
+
+// byte_wire: one word per byte, byte in bits 31..24.
+static void test_byte_wire() {
+    ws::CaptureStrip s(2);
+    ws::CaptureStrip::Options opt;
+    opt.byte_wire = true;
+    s.begin(opt);
+    s.setPixel(0, ws::RGB{1, 2, 3});
+    s.setPixel(1, ws::RGB{4, 5, 6});
+    s.show();
+    CHECK(last(s) == (Words{0x02000000u, 0x01000000u, 0x03000000u,
+                            0x05000000u, 0x04000000u, 0x06000000u}));
+}
+
+// Gamma 2.2 then brightness: 128 -> 56 -> 56 * 128 / 255 = 28; 255 -> 128.
+static void test_gamma_brightness() {
+    ws::CaptureStrip s(1);
+    s.begin();
+    s.enableGamma(true);
+    s.setBrightness(128);
+    s.setPixel(0, ws::RGB{128, 255, 0});
+    s.show();
+    CHECK(last(s) == (Words{0x801C0000u}));
+}
+
+// Per-channel tables: neutral settings match the shared-table path word for word.
+static void test_gamma_channels() {
+    const ws::RGB px[3] = {{128, 255, 0}, {1, 2, 3}, {200, 100, 50}};
+    ws::CaptureStrip ref(3), temp(3), four(3);
+    for (ws::CaptureStrip* s : {&ref, &temp, &four}) {
+        s->begin();
+        s->setBrightness(200);
+    }
+    ref.enableGamma(true);
+    temp.enableGamma(true);
+    temp.setColorTemperature(6600);
+    four.setGamma(ws::GAMMA_2_2, ws::GAMMA_2_2, ws::GAMMA_2_2, ws::GAMMA_2_2);
+    for (ws::CaptureStrip* s : {&ref, &temp, &four}) {
+        s->showFrom(px, 3);
+    }
+    CHECK(last(temp) == last(ref));
+    CHECK(last(four) == last(ref));
+
+    // Only G gets the curve: 128 -> 56.
+    ws::CaptureStrip mixed(1);
+    mixed.begin();
+    mixed.setGamma(ws::GAMMA_LINEAR, ws::GAMMA_2_2, ws::GAMMA_LINEAR, ws::GAMMA_LINEAR);
+    mixed.setPixel(0, ws::RGB{128, 128, 128});
+    mixed.show();
+    CHECK(last(mixed) == (Words{0x38808000u}));
+
+    // 200 * 176 / 255 = 138, 200 * 240 / 255 = 188; R untouched.
+    ws::CaptureStrip wb(1);
+    wb.begin();
+    wb.setWhiteBalance(ws::RGBW{255, 176, 240, 255});
+    wb.setPixel(0, ws::RGB{200, 200, 200});
+    wb.show();
+    CHECK(last(wb) == (Words{0x8AC8BC00u}));
+
+    // Warm white keeps R and drops B below G.
+    wb.setWhiteBalance(ws::RGBW{255, 255, 255, 255});
+    wb.setColorTemperature(2700);
+    wb.show();
+    const uint32_t w = last(wb)[0];
+    CHECK((w >> 16 & 0xFF) == 200 && (w >> 8 & 0xFF) < (w >> 24));
+}
+
+// depth16: temporal dithering averages to the 16-bit level over many frames.
+static void test_dither() {
+    ws::CaptureStrip s(1);
+    ws::CaptureStrip::Options opt;
+    opt.depth16 = true;
+    s.begin(opt);
+    s.setBrightness(10);
+    s.setPixel(0, ws::RGBW16{30000, 0, 0, 0});
+    const uint frames = 2560;
+    uint32_t sum = 0;
+    for (uint f = 0; f < frames; ++f) {
+        s.show();
+        sum += last(s)[0] >> 16 & 0xFF;     // R
+        s.clearFrames();
+    }
+    const double target = 30000.0 / 65535.0 * 10.0; // 4.578
+    const double avg = (double)sum / frames;
+    CHECK(avg > target - 0.02 && avg < target + 0.02);
+}
+
+// Power limiter: the frame that exceeds the budget goes out once, the next
+// is scaled to fit (100 LEDs x 3 x 20 mA + 1 mA idle each, 1000 mA budget).
+static void test_power_limit() {
+    ws::CaptureStrip s(100);
+    s.begin();
+    s.setPowerLimit(1000);
+    s.setAll(ws::RGB{255, 255, 255});
+    s.show();
+    CHECK(s.estimatedCurrent() == 6100);
+    CHECK(s.appliedBrightness() == 38);
+    s.show();
+    CHECK(s.estimatedCurrent() == 994);
+    CHECK(s.appliedBrightness() == 38);
+    CHECK(last(s)[0] == 0x26262600u);
+}
+
+// Only the dirty range is repacked, but the captured frame is always whole.
+static void test_dirty_repack() {
+    ws::CaptureStrip s(3);
+    s.begin();
+    s.setAll(ws::RGB{0, 0, 9});
+    s.show();
+    s.setPixel(1, ws::RGB{0, 7, 0});
+    s.show();
+    CHECK(last(s) == (Words{0x00000900u, 0x07000000u, 0x00000900u}));
+}
+
+static void test_segment() {
+    ws::CaptureStrip s(6);
+    ws::Segment all(s, 0, 6), back(s, 3, 3, /*reverse=*/true);
+    s.begin();
+    for (uint i = 0; i < 6; ++i) all.set(i, ws::RGB{(uint8_t)(i + 1), 0, 0});
+    all.shift(2);                           // 0 0 1 2 3 4
+    all.rotate(-1);                         // 0 1 2 3 4 0
+    back.fill(ws::RGB{0, 0, 5});            // 0 1 2 B B B
+    back.set(0, ws::RGB{9, 0, 0});          // reversed: physical pixel 5
+    s.show();
+    CHECK(last(s) == (Words{0x00000000u, 0x00010000u, 0x00020000u,
+                            0x00000500u, 0x00000500u, 0x00090000u}));
+
+    ws::Segment head(s, 0, 3);
+    head.copy(back);                        // logical order of back: 9, B, B
+    s.show();
+    CHECK(last(s)[0] == 0x00090000u && last(s)[1] == 0x00000500u && last(s)[2] == 0x00000500u);
+
+    ws::Segment odd(s, 1, 3, false, /*stride=*/2); // pixels 1, 3, 5
+    odd.fill(ws::RGB{0, 1, 0});
+    s.show();
+    CHECK(last(s)[1] == 0x01000000u && last(s)[3] == 0x01000000u && last(s)[5] == 0x01000000u);
+    CHECK(last(s)[4] == 0x00000500u);
+}
+
+// Blend and fade results, 8-bit and depth16: a + (b - a) * t / 256 rounded
+// down, nscale8 by (scale + 1) / 256.
+static void test_segment_blend() {
+    ws::CaptureStrip s(4);
+    ws::Segment all(s, 0, 4), one(s, 1, 1);
+    s.begin();
+    all.fill(ws::RGB{100, 200, 0});
+    all.blend(ws::RGBW{200, 100, 0, 0}, 64);      // up 25, down 25
+    CHECK(all.get(0).r == 125 && all.get(0).g == 175);
+    all.blend(ws::RGBW{0, 0, 0, 0}, 100);         // 125 - 48.8, 175 - 68.4
+    CHECK(all.get(3).r == 76 && all.get(3).g == 106);
+
+    all.fill(ws::RGB{200, 255, 1});
+    all.nscale8(127);                             // x 128 / 256
+    CHECK(all.get(0).r == 100 && all.get(0).g == 127 && all.get(0).b == 0);
+    all.fill(ws::RGB{200, 255, 1});
+    all.fadeToBlackBy(64);                        // x 192 / 256
+    CHECK(all.get(1).r == 150 && all.get(1).g == 191);
+
+    const ws::RGB a[1] = {{0, 100, 255}}, b[1] = {{255, 0, 255}};
+    one.blend(a, b, 1, 128);
+    CHECK(one.get(0).r == 127 && one.get(0).g == 50 && one.get(0).b == 255);
+    s.show();
+    CHECK(last(s)[1] == 0x327FFF00u && last(s)[0] == 0xBF960000u);
+
+    ws::CaptureStrip d(2);
+    ws::Segment wide(d, 0, 2);
+    ws::CaptureStrip::Options opt;
+    opt.depth16 = true;
+    d.begin(opt);
+    wide.fill(ws::RGBW16{40000, 10000, 0, 0});
+    wide.blend(ws::RGBW{0, 200, 0, 0}, 128);      // R 20000, G 10000 + 41400 / 2
+    CHECK(wide.get(0).r == 20000 >> 8 && wide.get(0).g == 30700 >> 8);
+    wide.fill(ws::RGBW16{40000, 10000, 0, 0});
+    wide.nscale8(127);
+    CHECK(wide.get(1).r == 20000 >> 8 && wide.get(1).g == 5000 >> 8);
+}
+
+// A view built before the strip dropped its pixel buffer does nothing.
+struct NoPixels : ws::CaptureStrip {
+    using ws::CaptureStrip::CaptureStrip;
+    using ws::PixelBuffer::release_pixels; // as Strip::begin() without pixel_buffer
+};
+
+static void test_segment_released() {
+    NoPixels s(8);
+    ws::Segment all(s, 0, 8), other(s, 2, 4, true);
+    s.release_pixels();
+    CHECK(!s.hasPixels());
+    all.fill(ws::RGB{1, 2, 3});
+    all.set(3, ws::RGB{1, 2, 3});
+    all.shift(2);
+    all.rotate(1);
+    all.blend(ws::RGBW{9, 9, 9, 9}, 100);
+    other.copy(all);
+    CHECK(all.get(3).r == 0);
+}
+
+static void test_rle() {
+    ws::RleFrame f(10);
+    CHECK(f.runs().size() == 1);
+    f.fill(2, 3, ws::RGB{1, 0, 0});         // split into 3 runs
+    CHECK(f.runs().size() == 3);
+    f.fill(5, 5, ws::RGB{1, 0, 0});         // merges with the middle run
+    CHECK(f.runs().size() == 2);
+    f.fill(0, 2, ws::RGB{1, 0, 0});         // everything one colour again
+    CHECK(f.runs().size() == 1);
+    CHECK(f.get(9).r == 1);
+}
+
+static void test_palette() {
+    ws::PaletteFrame f(5, /*bits=*/4);
+    f.setColor(1, ws::RGB{10, 0, 0});
+    f.setColor(15, ws::RGB{0, 0, 20});
+    f.fill(0, 5, 1);
+    f.set(3, 15);                           // high and low nibbles of one byte
+    f.set(4, 15);
+    f.set(4, 1);
+    CHECK(f.get(2) == 1 && f.get(3) == 15 && f.get(4) == 1);
+
+    ws::RGBW out[3] = {};
+    out[0].r = 77;
+    f.expand(3, 0, out);                    // odd first, nothing to write
+    CHECK(out[0].r == 77);
+    f.expand(3, 2, out);
+    CHECK(out[0].b == 20 && out[1].r == 10 && out[2].r == 0);
+}
+
+// A chunked palette frame goes out exactly as the same pixels through show().
+static void test_chunked_matches_show() {
+    for (bool byte_wire : {false, true}) {
+        ws::PaletteFrame f(100, 4);
+        f.setColor(1, ws::RGB{200, 100, 50});
+        f.setColor(2, ws::RGB{1, 2, 3});
+        for (uint i = 0; i < 100; ++i) f.set(i, (uint8_t)(i % 3));
+
+        ws::CaptureStrip a(100), b(100);
+        ws::CaptureStrip::Options opt;
+        opt.byte_wire = byte_wire;
+        a.begin(opt);
+        b.begin(opt);
+        a.enableGamma(true);
+        b.enableGamma(true);
+        a.setBrightness(77);
+        b.setBrightness(77);
+        a.showChunked(f, /*chunk_pixels=*/16);
+        for (uint i = 0; i < 100; ++i) b.setPixel(i, f.color(f.get(i)));
+        b.show();
+        CHECK(last(a) == last(b));
+    }
+}
+
+// Adalight: frames as byte strings, delivered frames recorded as R,G,B bytes.
+static std::vector<uint8_t> ada(const std::vector<uint8_t>& rgb, bool bad_sum = false) {
+    const uint n = (uint)rgb.size() / 3 - 1;
+    const uint8_t hi = (uint8_t)(n >> 8), lo = (uint8_t)n;
+    std::vector<uint8_t> f = {'A', 'd', 'a', hi, lo, (uint8_t)(hi ^ lo ^ 0x55 ^ (bad_sum ? 1 : 0))};
+    f.insert(f.end(), rgb.begin(), rgb.end());
+    return f;
+}
+
+struct AdaSink {
+    std::vector<std::vector<uint8_t>> frames;
+    static void fn(void* ctx, const ws::RGB* px, uint n) {
+        const uint8_t* p = &px->r;
+        static_cast<AdaSink*>(ctx)->frames.emplace_back(p, p + (size_t)n * 3);
+    }
+};
+
+static void test_adalight() {
+    const std::vector<uint8_t> one = {1, 2, 3, 4, 5, 6}, two = {7, 8, 9, 10, 11, 12};
+
+    // Bad checksum, line noise, then a good frame: dropped, resynchronized.
+    AdaSink sink;
+    ws::AdalightParser p(2, AdaSink::fn, &sink);
+    std::vector<uint8_t> in = ada(one, true);
+    const uint8_t noise[] = {'A', 'A', 'd', 0x00};
+    in.insert(in.end(), noise, noise + sizeof noise);
+    const std::vector<uint8_t> good = ada(two);
+    in.insert(in.end(), good.begin(), good.end());
+    p.feed(in.data(), in.size());
+    CHECK(p.errors() == 1 && p.frames() == 1);
+    CHECK(sink.frames.size() == 1 && sink.frames[0] == two);
+
+    // Byte by byte: header and payload split across every read.
+    in = ada(one);
+    for (uint8_t b : in) p.feed(&b, 1);
+    CHECK(p.frames() == 2 && sink.frames.back() == one);
+
+    // Contiguous room ahead: the parser waits instead of copying.
+    in = ada(two);
+    CHECK(p.consume(in.data(), 8, in.size()) == 6);
+    CHECK(p.consume(in.data() + 6, in.size() - 6, in.size() - 6) == in.size() - 6);
+    CHECK(p.frames() == 3 && sink.frames.back() == two);
+
+    // Truncated frame: nothing delivered; reset() drops it for the next header.
+    in = ada(one);
+    p.feed(in.data(), in.size() - 1);
+    CHECK(p.frames() == 3);
+    p.reset();
+    in = ada(two);
+    p.feed(in.data(), in.size());
+    CHECK(p.frames() == 4 && sink.frames.back() == two);
+
+    // Longer than max_pixels: cut to size, the rest skipped up to the next frame.
+    std::vector<uint8_t> three = one;
+    three.insert(three.end(), {13, 14, 15});
+    in = ada(three);
+    in.insert(in.end(), good.begin(), good.end());
+    p.feed(in.data(), in.size());
+    CHECK(p.frames() == 6 && sink.frames[4] == one && sink.frames[5] == two);
+}
+
+int main() {
+    test_orders();
+    test_byte_wire();
+    test_gamma_brightness();
+    test_gamma_channels();
+    test_dither();
+    test_power_limit();
+    test_dirty_repack();
+    test_segment();
+    test_segment_blend();
+    test_segment_released();
+    test_rle();
+    test_palette();
+    test_chunked_matches_show();
+    test_adalight();
+    if (s_failed) std::printf("%d check(s) failed\n", s_failed);
+    else std::printf("all host checks passed\n");
+    return s_failed ? 1 : 0;
+}